@@ -21,19 +21,45 @@
  *
  * NOTE: It is up to the user to use handles correctly. There is no way of knowing that handles
  *       match the cache which they are passed to.
+ *
+ * Free slots are reused according to the cache's free policy:
+ *      - LIFO (default) reuses the most recently freed slot first, in O(1).
+ *      - Lowest first reuses the lowest free index, found with a bitmap of used slots. This keeps
+ *        live items packed towards the start of storage under churn, so iteration touches fewer holes.
+ *
+ * Iteration also uses the used slots bitmap, skipping 64 free slots per word.
+ *
+ * Storage is either contiguous or paged:
+ *      - Contiguous caches double their item array with realloc when full. This moves every item,
+ *        so pointers returned by cache_get() are invalidated by any add that grows the cache.
+ *      - Paged caches allocate fixed-size pages on demand and never move an item once it has
+ *        been added. Pointers returned by cache_get() stay valid until that item is removed.
+ *        Use this for items that are held by pointer or that contain locks.
  */
 
 extern const int C_NULL_CACHE_HANDLE;
 
+enum CacheFreePolicy
+{
+    CACHE_FREE_POLICY_LIFO,
+    CACHE_FREE_POLICY_LOWEST_FIRST
+};
+
 struct Cache
 {
-    void* items;
-    int*  handles;
-    int   current_used;
-    int   max_used;
-    int   item_size;
-    int   capacity;
-    int   free_head;
+    void*  items;
+    void** pages;
+    int*   handles;
+    unsigned long long* used_bits;
+    int    current_used;
+    int    max_used;
+    int    item_size;
+    int    capacity;
+    int    page_shift;
+    int    page_count;
+    int    free_head;
+    int    free_hint;
+    enum CacheFreePolicy free_policy;
     alloc_fn alloc_func;
     free_fn  free_func;
 };
@@ -52,6 +78,15 @@ struct Cache* cache_new(int item_size, int capacity, alloc_fn alloc_func, free_f
  */
 void cache_init(struct Cache* cache, int item_size, int capacity, alloc_fn alloc_func, free_fn free_func);
 
+/* Create a new paged cache.
+ * The page capacity is rounded up to a power of two, and a new page is allocated each time the cache fills.
+ */
+struct Cache* cache_new_paged(int item_size, int page_capacity, alloc_fn alloc_func, free_fn free_func);
+
+/* Constructs a new paged cache in-place.
+ */
+void cache_init_paged(struct Cache* cache, int item_size, int page_capacity, alloc_fn alloc_func, free_fn free_func);
+
 /* Frees all the elements, calling the destructor if specified, then frees the cache.
  */
 void cache_free(struct Cache* cache);
@@ -69,6 +104,14 @@ int cache_size(const struct Cache* cache);
  */
 int cache_capacity(const struct Cache* cache);
 
+/* Sets how free slots are reused. Can be changed at any time.
+ */
+void cache_set_free_policy(struct Cache* cache, enum CacheFreePolicy free_policy);
+
+/* Returns whether the cache uses paged storage.
+ */
+bool cache_is_paged(const struct Cache* cache);
+
 /* Returns the size of a data element in bytes.
  */
 int cache_item_size(const struct Cache* cache);
@@ -112,6 +155,7 @@ struct CacheIt cache_begin(struct Cache* cache);
 struct CacheIt cache_end(struct Cache* cache);
 
 /* Get the next element in the cache.
+ * Skips free slots using the used slots bitmap.
  */
 struct CacheIt cache_it_next(struct CacheIt it);
 
@@ -5,20 +5,62 @@
 #include "scieppend/core/container_common.h"
 #include "scieppend/core/iterator.h"
 
-struct CacheMapBucketItem
+/* Hash map of items stored in a paged Cache.
+ * Item pointers returned by the map stay valid until the item is removed.
+ *
+ * Keys are looked up in an open addressing table. Each slot has a control byte holding either
+ * empty, deleted, or 7 bits of the key's hash. Slots are probed in groups of
+ * CACHE_MAP_GROUP_WIDTH control bytes, so a whole group can be matched against a key at once.
+ * Groups are matched with SSE2 where available, otherwise with a scalar loop.
+ * The table grows before it is 7/8 full, so every probe ends at an empty slot and inserts can
+ * not fail.
+ *
+ * Growing is incremental. The old table is kept alongside the new one, and each add or remove moves
+ * the next CACHE_MAP_MIGRATE_SLOTS old slots across, so no single insert pays for rehashing the whole
+ * map. Until the old table is empty, lookups that miss the new table also probe the old one.
+ *
+ * Each slot keeps a copy of its key and the key's 64-bit hash. Lookups compare the full hash,
+ * then the key bytes, so keys with colliding hashes never alias. Keys up to
+ * CACHE_MAP_INLINE_KEY_BYTES are stored in the slot, longer keys are allocated.
+ *
+ * The "hashed" functions take an int that is already unique per item, such as a component type
+ * handle, and use it as a 4 byte key. The "with_hash" functions take a key along with its
+ * precomputed hash64(), to skip hashing on the lookup.
+ */
+
+#define CACHE_MAP_GROUP_WIDTH 16
+#define CACHE_MAP_INLINE_KEY_BYTES 16
+#define CACHE_MAP_MIGRATE_SLOTS 32
+
+struct CacheMapSlot
+{
+    unsigned long long hash;
+    int                handle;
+    int                key_bytes;
+    union
+    {
+        char  inline_key[CACHE_MAP_INLINE_KEY_BYTES];
+        char* key;
+    };
+};
+
+struct CacheMapTable
 {
-    int key;
-    int handle;
+    int slot_count;
+    int growth_left;
+
+    signed char*         ctrl;
+    struct CacheMapSlot* slots;
 };
 
 struct CacheMap
 {
     int item_size;
-    int bucket_count;
-    int bucket_capacity;
+    int migrate_idx;
 
-    struct CacheMapBucketItem* bucket_items;
-    struct Cache cache;
+    struct CacheMapTable table;
+    struct CacheMapTable old_table; // Table being migrated from, or empty if not growing
+    struct Cache         cache;
 };
 
 // CREATIONAL
@@ -33,6 +75,7 @@ void             cache_map_uninit(struct CacheMap* map);
 int     cache_map_count(const struct CacheMap* map);
 void*   cache_map_get(const struct CacheMap* map, const void* key, int key_bytes);
 void*   cache_map_get_hashed(const struct CacheMap* map, int hashed_key);
+void*   cache_map_get_with_hash(const struct CacheMap* map, const void* key, int key_bytes, unsigned long long key_hash);
 float   cache_map_load_factor(const struct CacheMap* map);
 
 struct It cache_map_begin(struct CacheMap* map);
@@ -46,6 +89,7 @@ void cache_map_add(struct CacheMap* map, const void* key, int key_bytes, const v
 void cache_map_clear(struct CacheMap* map);
 void* cache_map_emplace(struct CacheMap* map, const void* key, int key_bytes, const void* args);
 void* cache_map_emplace_hashed(struct CacheMap* map, const int hashed_key, const void* args);
+void* cache_map_emplace_with_hash(struct CacheMap* map, const void* key, int key_bytes, unsigned long long key_hash, const void* args);
 void cache_map_remove(struct CacheMap* map, const void* key, int key_bytes);
 
 #endif
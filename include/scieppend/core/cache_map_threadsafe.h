@@ -0,0 +1,47 @@
+#ifndef SCIEPPEND_CORE_CACHE_MAP_THREADSAFE_H
+#define SCIEPPEND_CORE_CACHE_MAP_THREADSAFE_H
+
+#include "scieppend/core/cache_map.h"
+#include "scieppend/core/rw_lock.h"
+
+/* CacheMap guarded by a single reader/writer lock.
+ * Lookups take the lock for reading, so any number of threads can look up at once, and adding or
+ * removing takes it for writing. Item pointers stay valid after the lock is released until the
+ * item is removed, because the map stores items in a paged Cache.
+ *
+ * To iterate, or to check and insert as one step, take the lock with cache_map_ts_lock() and use
+ * the cache_map_* functions on the inner map.
+ */
+
+struct CacheMap_ThreadSafe
+{
+    struct CacheMap map;
+    struct RWLock   lock;
+};
+
+// CREATIONAL
+
+struct CacheMap_ThreadSafe* cache_map_ts_new(int item_size, int capacity, alloc_fn alloc_func, free_fn free_func);
+void                        cache_map_ts_free(struct CacheMap_ThreadSafe* map);
+void                        cache_map_ts_init(struct CacheMap_ThreadSafe* map, int item_size, int capacity, alloc_fn alloc_func, free_fn free_func);
+void                        cache_map_ts_uninit(struct CacheMap_ThreadSafe* map);
+
+// ACCESSORS
+
+int   cache_map_ts_count(const struct CacheMap_ThreadSafe* map);
+void* cache_map_ts_get(const struct CacheMap_ThreadSafe* map, const void* key, int key_bytes);
+void* cache_map_ts_get_hashed(const struct CacheMap_ThreadSafe* map, int hashed_key);
+void* cache_map_ts_get_with_hash(const struct CacheMap_ThreadSafe* map, const void* key, int key_bytes, unsigned long long key_hash);
+
+// MUTATORS
+
+void  cache_map_ts_add(struct CacheMap_ThreadSafe* map, const void* key, int key_bytes, const void* item);
+void  cache_map_ts_clear(struct CacheMap_ThreadSafe* map);
+void* cache_map_ts_emplace(struct CacheMap_ThreadSafe* map, const void* key, int key_bytes, const void* args);
+void* cache_map_ts_emplace_hashed(struct CacheMap_ThreadSafe* map, const int hashed_key, const void* args);
+void  cache_map_ts_remove(struct CacheMap_ThreadSafe* map, const void* key, int key_bytes);
+
+bool cache_map_ts_lock(const struct CacheMap_ThreadSafe* map, bool write);
+void cache_map_ts_unlock(const struct CacheMap_ThreadSafe* map, bool write);
+
+#endif
@@ -13,12 +13,15 @@ struct Cache_ThreadSafe
 
 struct Cache_ThreadSafe* cache_ts_new(int item_size, int capacity, alloc_fn alloc_func, free_fn free_func);
 void cache_ts_init(struct Cache_ThreadSafe* cache, int item_size, int capacity, alloc_fn alloc_func, free_fn free_func);
+struct Cache_ThreadSafe* cache_ts_new_paged(int item_size, int page_capacity, alloc_fn alloc_func, free_fn free_func);
+void cache_ts_init_paged(struct Cache_ThreadSafe* cache, int item_size, int page_capacity, alloc_fn alloc_func, free_fn free_func);
 void cache_ts_free(struct Cache_ThreadSafe* cache);
 void cache_ts_uninit(struct Cache_ThreadSafe* cache);
 int cache_ts_count(const struct Cache_ThreadSafe* cache);
 int cache_ts_capacity(const struct Cache_ThreadSafe* cache);
 int cache_ts_item_size(const struct Cache_ThreadSafe* cache);
 int cache_ts_used(const struct Cache_ThreadSafe* cache);
+void cache_ts_set_free_policy(struct Cache_ThreadSafe* cache, enum CacheFreePolicy free_policy);
 bool cache_ts_stale_handle(const struct Cache_ThreadSafe* cache, int handle);
 int cache_ts_add(struct Cache_ThreadSafe* cache, const void* item);
 int cache_ts_emplace(struct Cache_ThreadSafe* cache, void* args);
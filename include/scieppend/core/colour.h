@@ -81,6 +81,11 @@ struct Colour
  */
 bool colour_equal(struct Colour* c1, struct Colour* c2);
 
+/* Perceptual squared distance between two colours, the measure colour_similar() thresholds.
+ * See for details: https://www.compuphase.com/cmetric.htm
+ */
+int colour_distance(struct Colour* c1, struct Colour* c2);
+
 /* Check if two colours are similar.
  * See for details: https://www.compuphase.com/cmetric.htm
  */
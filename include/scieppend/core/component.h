@@ -8,7 +8,7 @@
 #include "scieppend/core/ecs_defs.h"
 #include "scieppend/core/string.h"
 
-#define NULL_COMPONENT_TYPE_PREHASH_MACRO 2025596145
+#define NULL_COMPONENT_TYPE_PREHASH_MACRO 288057177
 
 #define COMPONENT_TYPE_ID(type_name) SCIEPPEND_COMPONENT_TYPE_ID__##type_name
 
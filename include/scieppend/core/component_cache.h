@@ -41,8 +41,8 @@ void component_cache_remove_component(struct ComponentCache* component_cache, Co
 void component_cache_lock(const struct ComponentCache* component_cache, bool write);
 void component_cache_unlock(const struct ComponentCache* component_cache, bool write);
 
-void component_cache_register_observer(struct ComponentCache* component_cache, const ObserverHandle observer_handle);
-void component_cache_deregister_observer(struct ComponentCache* component_cache, const ObserverHandle observer_handle);
+void component_cache_register_observers(struct ComponentCache* component_cache, const ObserverHandle added_observer, const ObserverHandle removed_observer);
+void component_cache_deregister_observers(struct ComponentCache* component_cache, const ObserverHandle added_observer, const ObserverHandle removed_observer);
 void component_cache_send(const struct ComponentCache* component_cache, enum ECSEventType event_type, const EntityHandle entity_handle, const ComponentHandle component_handle);
 
 // Accessors
@@ -0,0 +1,53 @@
+#ifndef SCIEPPEND_CORE_CONCURRENT_SPSC_QUEUE_H
+#define SCIEPPEND_CORE_CONCURRENT_SPSC_QUEUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#define C_SPSC_QUEUE_CACHE_LINE 64
+
+/* Fixed capacity ring buffer for one producer thread and one consumer thread, without locks.
+ * Only the producer may push and only the consumer may pop. Capacity is rounded up to a power of two.
+ */
+struct SPSCQueue
+{
+    char*       buffer;
+    int         item_size;
+    int         mask;
+
+    // Head and tail are written by different threads, so keep them on separate cache lines
+    char        _pad0[C_SPSC_QUEUE_CACHE_LINE];
+    atomic_uint head; // Next slot the producer writes, only written by the producer
+    char        _pad1[C_SPSC_QUEUE_CACHE_LINE - sizeof(atomic_uint)];
+    atomic_uint tail; // Next slot the consumer reads, only written by the consumer
+    char        _pad2[C_SPSC_QUEUE_CACHE_LINE - sizeof(atomic_uint)];
+};
+
+// CREATIONAL
+
+struct SPSCQueue* spsc_queue_new(int item_size, int capacity);
+void              spsc_queue_free(struct SPSCQueue* queue);
+void              spsc_queue_init(struct SPSCQueue* queue, int item_size, int capacity);
+void              spsc_queue_uninit(struct SPSCQueue* queue);
+
+// ACCESSORS
+
+int spsc_queue_capacity(const struct SPSCQueue* queue);
+
+/* Number of items in the queue. Only exact when called from the producer or consumer thread while the other is idle.
+ */
+int spsc_queue_count(const struct SPSCQueue* queue);
+
+// MUTATORS
+
+/* Copies item into the queue. Returns false if the queue is full.
+ * PRODUCER ONLY
+ */
+bool spsc_queue_push(struct SPSCQueue* queue, const void* item);
+
+/* Copies the oldest item into out_item and removes it. Returns false if the queue is empty.
+ * CONSUMER ONLY
+ */
+bool spsc_queue_pop(struct SPSCQueue* queue, void* out_item);
+
+#endif
@@ -2,7 +2,16 @@
 #define SCIEPPEND_CORE_DRAW_H
 
 void draw_init(void);
+
+/* Initialises drawing to a fixed size terminal that is not attached to a tty.
+ * See term_init_headless().
+ */
+void draw_init_headless(int width, int height, const char* path);
 void draw_uninit(void);
+
+/* Starts a frame, applying any resize the terminal has signalled since the last one.
+ */
 void draw_begin(void);
+void draw_end(void);
 
 #endif
@@ -2,8 +2,7 @@
 #define SCIEPPEND_CORE_ECS_EVENTS_H
 
 #include "scieppend/core/ecs_defs.h"
-
-struct Event;
+#include "scieppend/core/event_channel.h"
 
 struct ECSEventArgs
 {
@@ -23,6 +22,9 @@ struct ComponentEventArgs
     ComponentHandle        component_handle;
 };
 
+EVENT_CHANNEL_DECL(EntityEvent, struct EntityEventArgs);
+EVENT_CHANNEL_DECL(ComponentEvent, struct ComponentEventArgs);
+
 enum ECSEventType component_event_get_event_type(struct ComponentEventArgs* args);
 enum ECSEventType entity_event_get_event_type(struct EntityEventArgs* args);
 
@@ -0,0 +1,42 @@
+#ifndef SCIEPPEND_CORE_ECS_RECORDER_H
+#define SCIEPPEND_CORE_ECS_RECORDER_H
+
+/* Records structural ECS operations to a binary file, and replays them into a world.
+ *
+ * While recording, every entity create and destroy, component add and remove, and system update is
+ * appended to the file as a fixed size little endian record. Component data is not recorded. Records
+ * are buffered and written in blocks. Recording can be done from any thread.
+ *
+ * Replaying drives a world through the same operations in the same order. Entity handles in the
+ * file are mapped to the handles the world gives out, so the world does not need to be empty. The
+ * world must already have the same component types and systems registered.
+ */
+
+#include "scieppend/core/ecs_defs.h"
+
+#include <stdbool.h>
+
+struct ECSWorld;
+
+/* Start recording to the file at path, overwriting it.
+ * Returns false if the file could not be opened, or if already recording.
+ */
+bool ecs_recorder_start(const char* path);
+
+/* Write any buffered records and close the file.
+ */
+void ecs_recorder_stop(void);
+
+bool ecs_recorder_is_recording(void);
+
+void ecs_recorder_record_entity_event(enum ECSEventType event_type, EntityHandle entity_handle);
+void ecs_recorder_record_component_event(enum ECSEventType event_type, EntityHandle entity_handle, ComponentTypeHandle component_type_handle, ComponentHandle component_handle);
+void ecs_recorder_record_update_systems(void);
+
+/* Replay the recording at path into the world.
+ * Returns the number of records replayed, or -1 if the file could not be read.
+ * Also returns -1 while recording, as the replayed operations would be recorded too.
+ */
+int ecs_replay(struct ECSWorld* world, const char* path);
+
+#endif
@@ -39,13 +39,17 @@ void ecs_world_unget_component(struct ECSWorld* world, const ComponentHandle com
 void ecs_world_component_type_register(struct ECSWorld* world, const ComponentTypeHandle component_type_handle, int bytes);
 void ecs_world_component_type_lock(struct ECSWorld* world, const ComponentTypeHandle component_type_handle, bool write);
 void ecs_world_component_type_unlock(struct ECSWorld* world, const ComponentTypeHandle component_type_handle, bool write);
-void ecs_world_component_type_register_observer(struct ECSWorld* world, const ComponentTypeHandle component_type_handle, const ObserverHandle observer);
-void ecs_world_component_type_deregister_observer(struct ECSWorld* world, const ComponentTypeHandle component_type_handle, const ObserverHandle observer);
+void ecs_world_component_type_register_observers(struct ECSWorld* world, const ComponentTypeHandle component_type_handle, const ObserverHandle added_observer, const ObserverHandle removed_observer);
+void ecs_world_component_type_deregister_observers(struct ECSWorld* world, const ComponentTypeHandle component_type_handle, const ObserverHandle added_observer, const ObserverHandle removed_observer);
 bool ecs_world_component_type_is_registered(struct ECSWorld* world, const ComponentTypeHandle component_type_handle);
 
 // System functions
 void ecs_world_system_register(struct ECSWorld* world, const struct string* system_name, const struct Array* required_components, SystemUpdateFn update_func);
 struct System* ecs_world_get_system(const struct ECSWorld* world, const struct string* system_name);
+
+/* Get a system by the string_intern() id of its name, which avoids hashing or comparing the name.
+ */
+struct System* ecs_world_get_system_by_id(const struct ECSWorld* world, int system_name_id);
 void ecs_world_update_systems(const struct ECSWorld* world);
 int ecs_world_system_entities_count(const struct ECSWorld* world, const struct string* system_name);
 
@@ -4,23 +4,71 @@
 #include "scieppend/core/array_threadsafe.h"
 #include "scieppend/core/event_defs.h"
 
+#include <stdatomic.h>
+#include <threads.h>
+
+struct ObserverList;
+
+/* Ring buffer of event args waiting for an event_flush.
+ */
+struct EventQueue
+{
+    mtx_t lock;
+    char* buffer;
+    int   args_size;
+    int   capacity;
+    int   head;
+    int   count;
+
+    char* batch; // Args taken out of the ring by the current flush
+    int   batch_capacity;
+};
+
+/* Observer handles are kept in a locked array, which is only touched when observers are registered
+ * or deregistered. Each change also publishes a new immutable ObserverList holding copies of the
+ * observers, which is what event_send and event_flush read. Sending is a single atomic load of the
+ * current list, with no locks. Replaced lists are kept until event_uninit, since a sender on another
+ * thread may still be reading one.
+ *
+ * The lists hold copies of the observers, so an observer must be deregistered from every event before
+ * it is destroyed. A list published before the destroy would still call it with its old data.
+ * Handles that have been destroyed are left out of lists published after it.
+ *
+ * Events are either immediate or queued.
+ * Immediate events call every observer from inside event_send.
+ * Queued events copy the args into a ring buffer in event_send, and call observers with everything
+ * queued so far in event_flush. Observers with a batch callback get all the args in one call,
+ * others get their callback called once per args.
+ */
 struct Event
 {
-    struct Array_ThreadSafe observers;
+    struct Array_ThreadSafe       observers;
+    _Atomic(struct ObserverList*) observer_list;
+    struct ObserverList*          retired_lists; // Replaced lists, freed on uninit
+    struct EventQueue*            queue;         // NULL for immediate events
 };
 
 ObserverHandle observer_create(void* observer_data, event_callback_fn callback_func);
+ObserverHandle observer_create_batched(void* observer_data, event_callback_fn callback_func, event_batch_callback_fn batch_callback_func);
 void observer_destroy(ObserverHandle handle);
 
 struct Event* event_new(void);
 void event_free(struct Event* event);
 void event_init(struct Event* event);
+void event_init_queued(struct Event* event, int args_size, int capacity);
 void event_uninit(struct Event* event);
 int  event_observer_count(const struct Event* event);
+int  event_queued_count(const struct Event* event);
 void event_register_observer(struct Event* event, ObserverHandle obs_handle);
 void event_deregister_observer(struct Event* event, ObserverHandle obs_handle);
 void event_send(const struct Event* event, void* event_args);
 
+/* Send all queued args to the observers.
+ * Does nothing for immediate events. Events sent while flushing are left for the next flush.
+ * Must not be called for the same event from more than one thread at once.
+ */
+void event_flush(const struct Event* event);
+
 void eventing_init(void);
 void eventing_uninit(void);
 
@@ -0,0 +1,53 @@
+#ifndef SCIEPPEND_CORE_EVENT_CHANNEL_H
+#define SCIEPPEND_CORE_EVENT_CHANNEL_H
+
+/* Macros to help with defining typed event channels.
+ * A channel ties an Event to one args type, so sending and observer callbacks are type checked, and
+ * queued channels store args of a size known at compile time.
+ *
+ *  EVENT_CHANNEL_DECL(EntityEvent, struct EntityEventArgs);
+ *
+ *  static void _on_created(const struct Event* sender, void* obs_data, const struct EntityEventArgs* args) { ... }
+ *  EVENT_CHANNEL_OBSERVER_DEF(EntityEvent, _on_created);
+ *
+ *  ObserverHandle obs = observer_create(data, EVENT_CHANNEL_OBSERVER(_on_created));
+ *  EVENT_CHANNEL_SEND(EntityEvent)(&event, &args);
+ */
+
+#include "scieppend/core/event.h"
+
+#define EVENT_CHANNEL_ARGS(channel_name) SCIEPPEND_EVENT_CHANNEL_ARGS__##channel_name
+
+#define EVENT_CHANNEL_CALLBACK(channel_name) SCIEPPEND_EVENT_CHANNEL_CALLBACK__##channel_name
+
+#define EVENT_CHANNEL_SEND(channel_name) SCIEPPEND_EVENT_CHANNEL_SEND__##channel_name
+
+#define EVENT_CHANNEL_INIT_QUEUED(channel_name) SCIEPPEND_EVENT_CHANNEL_INIT_QUEUED__##channel_name
+
+#define EVENT_CHANNEL_OBSERVER(callback_name) &SCIEPPEND_EVENT_CHANNEL_OBSERVER__##callback_name
+
+#define EVENT_CHANNEL_DECL(channel_name, args_type)\
+    typedef args_type EVENT_CHANNEL_ARGS(channel_name);\
+    typedef void(*EVENT_CHANNEL_CALLBACK(channel_name))(const struct Event* sender, void* obs_data, const args_type* args);\
+    static inline void EVENT_CHANNEL_SEND(channel_name)(const struct Event* event, const args_type* args)\
+    {\
+        event_send(event, (void*)args);\
+    }\
+    static inline void EVENT_CHANNEL_INIT_QUEUED(channel_name)(struct Event* event, int capacity)\
+    {\
+        event_init_queued(event, sizeof(args_type), capacity);\
+    }\
+    typedef args_type EVENT_CHANNEL_ARGS(channel_name)
+
+/* Define the untyped callback that forwards to a typed callback.
+ * Fails to compile if the callback does not take the channel's args type.
+ */
+#define EVENT_CHANNEL_OBSERVER_DEF(channel_name, callback_name)\
+    static void SCIEPPEND_EVENT_CHANNEL_OBSERVER__##callback_name(const struct Event* sender, void* obs_data, void* event_args)\
+    {\
+        EVENT_CHANNEL_CALLBACK(channel_name) typed_callback = &callback_name;\
+        typed_callback(sender, obs_data, event_args);\
+    }\
+    typedef int SCIEPPEND_EVENT_CHANNEL_OBSERVER_DEF__##callback_name
+
+#endif
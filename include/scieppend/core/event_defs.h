@@ -4,6 +4,14 @@
 struct Event;
 
 typedef void(*event_callback_fn)(const struct Event* sender, void* obs_data, void* event_args);
+
+/* Receives every queued event args of a flush at once, as a contiguous array of count items of
+ * args_size bytes each.
+ * An observer with only a batch callback can also observe immediate events, which call it with a
+ * count of 1 for each send. Immediate events do not know the size of their args, so args_size is 0.
+ */
+typedef void(*event_batch_callback_fn)(const struct Event* sender, void* obs_data, void* event_args, int count, int args_size);
+
 typedef int ObserverHandle;
 
 #endif
@@ -1,6 +1,25 @@
 #ifndef SCIEPPEND_CORE_HASH_H
 #define SCIEPPEND_CORE_HASH_H
 
+/* Hash functions.
+ *
+ * The output of both functions is fixed, and is the same on every platform and compiler, so hashes
+ * can be precomputed and stored. hash64() is defined as:
+ *      1) h = seed ^ size
+ *      2) If size >= 32, whole 32 byte stripes are hashed by 4 lanes, each taking one 8 byte little
+ *         endian word per stripe, and the lanes are merged back into h.
+ *      3) The remaining whole 8 byte words are mixed into h one at a time.
+ *      4) The last 0 to 7 bytes are mixed in as a zero padded word, then h is finalised with the size.
+ * Each mix is a 64x64 -> 128 bit multiply with the halves xor'd together.
+ *
+ * hash() is hash64() with the two halves xor'd into 32 bits.
+ */
+
 int hash(const char* buffer, const int size_bytes);
 
+/* 64-bit hash in the style of wyhash.
+ * Consumes 32 bytes per iteration for long keys, then 8 bytes per step.
+ */
+unsigned long long hash64(const void* buffer, const int size_bytes);
+
 #endif
@@ -5,7 +5,48 @@
 
 #include <stdbool.h>
 
+/* Input is read and parsed on its own thread, which queues key presses as they arrive.
+ * input_poll() takes everything queued since the last poll without making any system calls.
+ */
+
+#define INPUT_PARSER_BUFFER_SIZE 512
+
+/* Turns the bytes read from the terminal into key presses.
+ * An escape sequence can arrive split across reads, so one that has not fully arrived yet is kept pending until the
+ * next feed, or until input_parser_flush() decides it was an escape key press.
+ */
+struct InputParser
+{
+    char         pending[INPUT_PARSER_BUFFER_SIZE];
+    int          pending_length;
+    enum KeyCode keys[INPUT_PARSER_BUFFER_SIZE]; // Keys parsed by the last feed or flush
+    int          key_count;
+};
+
+void input_parser_init(struct InputParser* parser);
+
+/* Parses the bytes, after any left pending, into parser->keys. Unknown escape sequences are skipped whole.
+ * If the pending bytes fill up with an escape sequence that never ends, it is given up on as if flushed.
+ * Keys past INPUT_PARSER_BUFFER_SIZE in one call are dropped.
+ */
+void input_parser_feed(struct InputParser* parser, const char* bytes, int length);
+
+/* Parses the pending bytes into parser->keys, taking the escape that starts an incomplete sequence as an escape key.
+ */
+void input_parser_flush(struct InputParser* parser);
+
+/* Whether the parser is waiting on the rest of an escape sequence.
+ */
+bool input_parser_has_pending(const struct InputParser* parser);
+
+/* Whether the key was pressed before the last poll. KEYCODE_UNKNOWN checks for any key.
+ */
 bool input_get_key(enum KeyCode key);
+
+/* Keys pressed before the last poll in the order they were typed, including repeats.
+ */
+const enum KeyCode* input_get_keys(int* count);
+
 void input_poll(void);
 void input_init(void);
 void input_uninit(void);
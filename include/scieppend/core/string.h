@@ -2,14 +2,28 @@
 #define SCIEPPEND_CORE_STRING_H
 
 /* String implementation.
+ *
+ * Strings of up to STRING_INLINE_CAPACITY characters are stored inside the struct, longer strings
+ * are allocated. The hash of the characters is kept up to date whenever they change, so hashing
+ * a string is free.
  */
 
 #include <stddef.h>
 
+#define STRING_INLINE_CAPACITY 15
+
+extern const int C_NULL_STRING_ID;
+
 struct string
 {
-    char* buffer;
-    int   size;
+    union
+    {
+        char* heap_buffer;
+        char  inline_buffer[STRING_INLINE_CAPACITY + 1];
+    };
+    int                size;
+    int                capacity; // Characters that fit without reallocating, not counting the terminator
+    unsigned long long hash;     // hash64() of the characters
 };
 
 /* Create a string with the given characters.
@@ -25,10 +39,21 @@ void string_free(struct string* str);
  */
 void string_init(struct string* str, const char* initial);
 
+/* Initialise a string that takes ownership of an allocated, null terminated buffer.
+ * The buffer must have room for capacity characters plus the terminator, and capacity must be more
+ * than STRING_INLINE_CAPACITY.
+ */
+void string_init_take_buffer(struct string* str, char* buffer, int size, int capacity);
+
 /* Frees the string internals but does not free the string itself.
  */
 void string_uninit(struct string* str);
 
+/* Get the null terminated characters of the string.
+ * The pointer is invalidated by any change to the string.
+ */
+const char* string_cstr(const struct string* str);
+
 /* Get the size of the string in characters used.
  */
 int string_size(struct string* str);
@@ -49,8 +74,32 @@ void string_set(struct string* str, const char* buffer);
  */
 void string_format(struct string* str, const char* format, ...);
 
-/* Hash the string
+/* Hash the string.
+ * Same as hash() of the characters, but cached.
  */
 int string_hash(const struct string* str);
 
+/* Get the cached hash64() of the characters.
+ */
+unsigned long long string_hash64(const struct string* str);
+
+/* Intern the string's characters and return the id for them.
+ * Equal strings always get the same id, so interned strings can be compared by id. The intern table
+ * is set up on first use and ids stay valid for the life of the program. Safe to call from any thread.
+ */
+int string_intern(const struct string* str);
+
+/* Intern null terminated characters and return the id for them.
+ */
+int string_intern_chars(const char* chars);
+
+/* Get the id of the string's characters if they have been interned, or C_NULL_STRING_ID if not.
+ * Unlike string_intern, never adds to the table.
+ */
+int string_intern_find(const struct string* str);
+
+/* Get the characters for an interned id, or NULL if the id is not interned.
+ */
+const char* string_intern_get(int id);
+
 #endif
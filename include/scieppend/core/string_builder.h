@@ -0,0 +1,69 @@
+#ifndef SCIEPPEND_CORE_STRING_BUILDER_H
+#define SCIEPPEND_CORE_STRING_BUILDER_H
+
+/* Growable buffer for building up text with appends.
+ * The buffer doubles when it runs out of room, so appending is amortised O(1) per character, and
+ * it is reused across string_builder_clear calls. The integer and character appends write digits
+ * directly, without going through printf format parsing.
+ *
+ * A zeroed StringBuilder is valid and empty, and allocates on the first append. A builder can also
+ * start out in a caller's buffer, e.g. one on the stack, and only allocates if it outgrows it.
+ */
+
+#include <stdarg.h>
+
+struct string;
+
+struct StringBuilder
+{
+    char* buffer;
+    int   size;
+    int   capacity;    // Bytes available, including room for the terminator
+    bool  owns_buffer; // False while still writing into the buffer given to string_builder_init_buffer
+};
+
+struct StringBuilder* string_builder_new(int capacity);
+void                  string_builder_free(struct StringBuilder* builder);
+void                  string_builder_init(struct StringBuilder* builder, int capacity);
+void                  string_builder_uninit(struct StringBuilder* builder);
+
+/* Initialise a builder that writes into the given buffer until it needs more than capacity bytes,
+ * then moves to an allocated one. The buffer must outlive the builder, and uninit is still needed.
+ */
+void string_builder_init_buffer(struct StringBuilder* builder, char* buffer, int capacity);
+
+/* Get the null terminated characters built so far.
+ * The pointer is invalidated by any append.
+ */
+const char* string_builder_cstr(const struct StringBuilder* builder);
+int         string_builder_size(const struct StringBuilder* builder);
+
+/* Empty the builder, keeping its buffer for reuse.
+ */
+void string_builder_clear(struct StringBuilder* builder);
+
+/* Make sure at least size more characters can be appended without reallocating.
+ */
+void string_builder_reserve(struct StringBuilder* builder, int size);
+
+void string_builder_append(struct StringBuilder* builder, const char* chars);
+void string_builder_append_chars(struct StringBuilder* builder, const char* chars, int size);
+void string_builder_append_char(struct StringBuilder* builder, char c);
+void string_builder_append_repeat(struct StringBuilder* builder, char c, int count);
+void string_builder_append_int(struct StringBuilder* builder, int value);
+void string_builder_append_uint(struct StringBuilder* builder, unsigned int value);
+void string_builder_append_string(struct StringBuilder* builder, const struct string* str);
+
+/* Expand the format onto the end of the builder.
+ * Formats straight into the builder's buffer, so there is no fixed size limit.
+ */
+void string_builder_append_format(struct StringBuilder* builder, const char* format, ...);
+void string_builder_append_vformat(struct StringBuilder* builder, const char* format, va_list args);
+
+/* Initialise a string with the built characters and empty the builder.
+ * If the characters are too long to be stored inline and the builder has allocated its buffer, the
+ * string takes ownership of it rather than copying it.
+ */
+void string_builder_to_string(struct StringBuilder* builder, struct string* str);
+
+#endif
@@ -30,7 +30,10 @@ struct System
     enum SystemState state;
     struct ECSWorld* world;
     SystemUpdateFn update_func;
-    ObserverHandle observer_handle;
+    ObserverHandle entity_created_observer;
+    ObserverHandle entity_destroyed_observer;
+    ObserverHandle component_added_observer;
+    ObserverHandle component_removed_observer;
     struct Array required_components;
     struct Array_ThreadSafe entity_handles;
     struct Array_ThreadSafe ecs_commands;
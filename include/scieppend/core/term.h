@@ -22,21 +22,51 @@ enum TextAttributeFlag
 };
 typedef unsigned int TextAttributeFlags;
 
+enum TermColourMode
+{
+    COLOUR_MODE_TRUE, // 24 bit colour
+    COLOUR_MODE_256,  // xterm 256 colour palette
+    COLOUR_MODE_16    // Basic and bright ANSI colours
+};
+
+/* Output counters for a headless terminal.
+ */
+struct TermSinkStats
+{
+    unsigned long long frames;
+    unsigned long long bytes;
+    unsigned long long escape_sequences;
+    unsigned long long frame_bytes;            // Bytes written by the last refresh
+    unsigned long long frame_escape_sequences; // Escape sequences written by the last refresh
+};
+
 /* Initialises the terminal, taking over the altbuffer and setting up internal state.
  * Won't do anything if the terminal has already been initialised.
  */
 void term_init(void);
 
+/* Initialises a terminal of fixed size that is not attached to a tty, for benchmarking and testing the renderer.
+ * Output is counted, see term_get_sink_stats(), and written to the file at path if it is not NULL.
+ * Won't do anything if the terminal has already been initialised.
+ */
+void term_init_headless(int width, int height, const char* path);
+
 /* Uninitialise the terminal, clean up state, return terminal to previous state (hopefully).
  */
 void term_uninit(void);
 
+/* Gets output counters of a headless terminal.
+ * The render thread updates them without synchronisation, so only call this while it is stopped.
+ */
+void term_get_sink_stats(struct TermSinkStats* stats);
+
 /* Gets the width and height of the terminals in characters.
  * i.e. how many characters are in each row and column.
  */
 void term_get_wh(int* w, int* h);
 
 /* Sets cursor visibility.
+ * Takes effect immediately, or with the next refresh while the render thread is running.
  */
 void term_set_cursor(bool on);
 
@@ -53,10 +83,27 @@ void term_set_canon(bool state);
 void term_set_sigint_callback(void(*sig)(int));
 
 /* Force resize of terminal state.
+ * Stops the render thread while the buffers are reallocated, so must not be called from a signal handler.
  */
 void term_resize(void);
 
+/* Starts a thread that takes over writing to the terminal.
+ * term_refresh() then hands the frame over and returns immediately. If the terminal cannot keep up, frames the render
+ * thread has not got to yet are dropped in favour of newer ones.
+ */
+void term_start_render_thread(void);
+
+/* Stops the render thread once it has written the last frame handed to it.
+ */
+void term_stop_render_thread(void);
+
+/* Sets how colours are sent to the terminal, colours are quantized to the nearest palette entry for palette modes.
+ * The whole display is redrawn on the next refresh. Defaults to COLOUR_MODE_TRUE.
+ */
+void term_set_colour_mode(enum TermColourMode mode);
+
 /* Clears the entire terminal of display content.
+ * Only cells that were showing something are rewritten on the next refresh.
  */
 void term_clear(void);
 
@@ -65,10 +112,12 @@ void term_clear(void);
 void term_clear_area(int x, int y, int w, int h);
 
 /* Writes to and flushes the terminal display buffer.
+ * Only cells that differ from what was displayed by the previous refresh are written.
  */
 void term_refresh(void);
 
 /* Move the cursor to given x y position.
+ * The cursor is moved there after the next refresh, and put back there after each refresh that follows.
  */
 void term_move_cursor(int x, int y);
 
@@ -80,10 +129,22 @@ void term_set_attr(int x, int y, TextAttributeFlags ta_flags);
  */
 void term_unset_attr(int x, int y, TextAttributeFlags ta_flags);
 
+/* Adds a glyph to the glyph table and returns its id for term_draw_glyph(), or -1 if the table is full or the glyph is
+ * invalid. utf8 is a single character of at most 4 bytes, width is how many columns it takes up, 1 or 2.
+ * Registering the same bytes again returns the existing id. The table is reset by term_init().
+ */
+int term_register_glyph(const char* utf8, int width);
+
 /* Draw given symbol with given parameters.
+ * ASCII symbols are their own glyph ids, so values above 127 draw registered glyphs.
  */
 void term_draw_symbol(int x, int y, struct Colour* fg, struct Colour* bg, TextAttributeFlags ta_flags, char symbol);
 
+/* Draw a glyph from term_register_glyph(), or an ASCII character, with given parameters.
+ * A wide glyph also covers the cell to its right.
+ */
+void term_draw_glyph(int x, int y, struct Colour* fg, struct Colour* bg, TextAttributeFlags ta_flags, int glyph);
+
 /* Draw a string, beginning at x y and extending horizontally, with given parameters.
  */
 void term_draw_text(int x, int y, struct Colour* fg, struct Colour* bg, TextAttributeFlags ta_flags, const char* text);
@@ -3,6 +3,7 @@
 
 void test_cache_map_add(void);
 void test_cache_map_remove(void);
+void test_cache_map_threadsafe(void);
 void test_cache_map_run_all(void);
 
 #endif
@@ -3,6 +3,9 @@
 
 void test_event_register_deregister(void);
 void test_event_send(void);
+void test_event_send_queued(void);
+void test_event_send_channel(void);
+void test_event_send_concurrent(void);
 void test_event_run_all(void);
 
 #endif
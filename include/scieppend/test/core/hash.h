@@ -0,0 +1,8 @@
+#ifndef SCIEPPEND_TEST_CORE_HASH_H
+#define SCIEPPEND_TEST_CORE_HASH_H
+
+void test_hash_stable(void);
+void test_hash_unaligned(void);
+void test_hash_run_all(void);
+
+#endif
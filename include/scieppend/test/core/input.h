@@ -0,0 +1,8 @@
+#ifndef SCIEPPEND_TEST_CORE_INPUT_H
+#define SCIEPPEND_TEST_CORE_INPUT_H
+
+void test_input_parser(void);
+void test_input_thread(void);
+void test_input_run_all(void);
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef SCIEPPEND_TEST_CORE_SPSC_QUEUE_H
+#define SCIEPPEND_TEST_CORE_SPSC_QUEUE_H
+
+void test_spsc_queue_push_pop(void);
+void test_spsc_queue_threaded(void);
+void test_spsc_queue_run_all(void);
+
+#endif
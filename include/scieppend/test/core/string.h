@@ -0,0 +1,8 @@
+#ifndef SCIEPPEND_TEST_CORE_STRING_H
+#define SCIEPPEND_TEST_CORE_STRING_H
+
+void test_string_storage(void);
+void test_string_intern(void);
+void test_string_run_all(void);
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef SCIEPPEND_TEST_CORE_STRING_BUILDER_H
+#define SCIEPPEND_TEST_CORE_STRING_BUILDER_H
+
+void test_string_builder_append(void);
+void test_string_builder_to_string(void);
+void test_string_builder_run_all(void);
+
+#endif
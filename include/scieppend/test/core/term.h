@@ -0,0 +1,7 @@
+#ifndef SCIEPPEND_TEST_CORE_TERM_H
+#define SCIEPPEND_TEST_CORE_TERM_H
+
+void test_term_headless(void);
+void test_term_run_all(void);
+
+#endif
@@ -0,0 +1,126 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "scieppend/core/colour.h"
+#include "scieppend/core/hash.h"
+#include "scieppend/core/term.h"
+
+#include <stdio.h>
+#include <time.h>
+
+/* Hash throughput benchmark.
+ * Compares hash() against the byte at a time FNV-1 loop it replaced, over a range of key sizes.
+ *
+ * Render benchmark.
+ * Draws frames into a headless terminal and reports encoding throughput and bytes per frame.
+ */
+
+#define C_BENCH_BUFFER_BYTES 4096
+#define C_BENCH_TOTAL_BYTES (256 * 1024 * 1024)
+
+static const int C_BENCH_SIZES[] = { 4, 8, 16, 24, 32, 64, 128, 256, 1024, 4096 };
+
+#define C_BENCH_RENDER_WIDTH 200
+#define C_BENCH_RENDER_HEIGHT 60
+#define C_BENCH_RENDER_FRAMES 2000
+
+typedef int(*bench_hash_fn)(const char* buffer, const int size_bytes);
+
+// INTERNAL FUNCS
+
+static int _hash_fnv1(const char* buffer, const int size_bytes)
+{
+    long hash = 0x811c9dc5;
+    for(int i = 0; i < size_bytes; ++i)
+    {
+        hash = hash * 0x01000193;
+        hash = hash ^ buffer[i];
+    }
+
+    return (int)hash;
+}
+
+static double _now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+static double _bench(bench_hash_fn fn, const char* buffer, int size_bytes, int* sink)
+{
+    int iterations = C_BENCH_TOTAL_BYTES / size_bytes;
+    int offset_mask = (C_BENCH_BUFFER_BYTES - size_bytes);
+
+    double start = _now_seconds();
+    for(int i = 0; i < iterations; ++i)
+    {
+        // Feed the previous result into the offset so calls can't be hoisted out of the loop
+        int offset = offset_mask > 0 ? (unsigned int)(*sink + i) % (unsigned int)offset_mask : 0;
+        *sink ^= fn(buffer + offset, size_bytes);
+    }
+    double elapsed = _now_seconds() - start;
+
+    return ((double)iterations * size_bytes) / elapsed / (1024.0 * 1024.0 * 1024.0);
+}
+
+/* Redraws the whole screen every frame with colours that shift by one cell per frame, so every cell changes.
+ */
+static void _bench_render(enum TermColourMode mode, const char* mode_name)
+{
+    term_init_headless(C_BENCH_RENDER_WIDTH, C_BENCH_RENDER_HEIGHT, NULL);
+    term_set_colour_mode(mode);
+
+    double start = _now_seconds();
+    for(int frame = 0; frame < C_BENCH_RENDER_FRAMES; ++frame)
+    {
+        for(int y = 0; y < C_BENCH_RENDER_HEIGHT; ++y)
+        for(int x = 0; x < C_BENCH_RENDER_WIDTH; ++x)
+        {
+            struct Colour* fg = &g_colours[(x + y + frame) % CLR_DEFAULT];
+            struct Colour* bg = &g_colours[((x / 8) + frame) % CLR_DEFAULT];
+            term_draw_symbol(x, y, fg, bg, A_NONE_BIT, 'a' + ((x + frame) % 26));
+        }
+
+        term_refresh();
+    }
+    double elapsed = _now_seconds() - start;
+
+    struct TermSinkStats stats;
+    term_get_sink_stats(&stats);
+    term_uninit();
+
+    printf("%10s %14.1f %14.2f %14llu\n",
+           mode_name,
+           (double)stats.frames / elapsed,
+           (double)stats.bytes / elapsed / (1024.0 * 1024.0),
+           stats.bytes / stats.frames);
+}
+
+// EXTERNAL FUNCS
+
+int main(void)
+{
+    static char buffer[C_BENCH_BUFFER_BYTES];
+    for(int i = 0; i < C_BENCH_BUFFER_BYTES; ++i)
+    {
+        buffer[i] = (char)(i * 31 + 7);
+    }
+
+    int sink = 0;
+
+    printf("%10s %14s %14s\n", "bytes", "fnv1 GiB/s", "hash GiB/s");
+    for(unsigned int i = 0; i < sizeof(C_BENCH_SIZES) / sizeof(C_BENCH_SIZES[0]); ++i)
+    {
+        int size_bytes = C_BENCH_SIZES[i];
+        double fnv1 = _bench(&_hash_fnv1, buffer, size_bytes, &sink);
+        double wide = _bench(&hash, buffer, size_bytes, &sink);
+        printf("%10d %14.2f %14.2f\n", size_bytes, fnv1, wide);
+    }
+
+    printf("\n%10s %14s %14s %14s\n", "colours", "frames/s", "MiB/s", "bytes/frame");
+    _bench_render(COLOUR_MODE_TRUE, "true");
+    _bench_render(COLOUR_MODE_256, "256");
+    _bench_render(COLOUR_MODE_16, "16");
+
+    return sink == 0x7fffffff;
+}
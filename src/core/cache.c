@@ -47,51 +47,210 @@ static int _get_item_offset(int item_size, int handle)
     return item_size * _get_idx(handle);
 }
 
-// Returns pointer to the item in the cache items array
+// Returns pointer to the item in the cache items array, or in its page if the cache is paged
 static void* _get_item(const struct Cache* cache, int handle)
 {
+    if(cache->pages)
+    {
+        int idx = _get_idx(handle);
+        int page_mask = (1 << cache->page_shift) - 1;
+        return (char*)cache->pages[idx >> cache->page_shift] + (cache->item_size * (idx & page_mask));
+    }
+
     return (char*)cache->items + _get_item_offset(cache->item_size, handle);
 }
 
+// Smallest power of two shift that will hold the given number of items
+static int _get_page_shift(int page_capacity)
+{
+    int shift = 0;
+    while((1 << shift) < page_capacity)
+    {
+        ++shift;
+    }
+
+    return shift;
+}
+
+// Set newly allocated handles to the null handle
+static void _init_handles(struct Cache* cache, int from, int to)
+{
+    for(int i = from; i < to; ++i)
+    {
+        cache->handles[i] = C_NULL_CACHE_HANDLE;
+    }
+}
+
 // Check whether the free list has items.
 static bool _free_list_empty(struct Cache* cache)
 {
     return (_get_idx(cache->free_head) & C_IDX_MASK) == C_IDX_MASK;
 }
 
-/* Get the next handle index, either from the free list or open up a new entry.
+// Bit logic to get the used bits word for an index
+static int _get_bits_word(int idx)
+{
+    return idx >> 6;
+}
+
+// Bit logic to get the bit within a used bits word for an index
+static unsigned long long _get_bits_mask(int idx)
+{
+    return 1ull << (idx & 63);
+}
+
+// Number of used bits words needed to cover the given capacity
+static int _get_bits_word_count(int capacity)
+{
+    return (capacity + 63) >> 6;
+}
+
+// Grow the used bits to cover a new capacity, with the new bits unset
+static void _resize_used_bits(struct Cache* cache, int old_capacity, int new_capacity)
+{
+    int old_words = _get_bits_word_count(old_capacity);
+    int new_words = _get_bits_word_count(new_capacity);
+
+    if(new_words == old_words)
+    {
+        return;
+    }
+
+    cache->used_bits = realloc(cache->used_bits, sizeof(unsigned long long) * new_words);
+    if(!cache->used_bits)
+    {
+        abort();
+    }
+
+    memset(cache->used_bits + old_words, 0, sizeof(unsigned long long) * (new_words - old_words));
+}
+
+static void _set_used(struct Cache* cache, int idx)
+{
+    cache->used_bits[_get_bits_word(idx)] |= _get_bits_mask(idx);
+}
+
+static void _set_unused(struct Cache* cache, int idx)
+{
+    cache->used_bits[_get_bits_word(idx)] &= ~_get_bits_mask(idx);
+
+    if(_get_bits_word(idx) < cache->free_hint)
+    {
+        cache->free_hint = _get_bits_word(idx);
+    }
+}
+
+/* Find the lowest free slot below max_used.
+ * Words before the free hint are known to be full, so the scan starts from there.
+ * Return the index mask if there are no free slots.
+ */
+static int _find_lowest_free_idx(struct Cache* cache)
+{
+    int word_count = _get_bits_word_count(cache->max_used);
+
+    for(int word = cache->free_hint; word < word_count; ++word)
+    {
+        unsigned long long free_bits = ~cache->used_bits[word];
+        if(free_bits != 0)
+        {
+            cache->free_hint = word;
+
+            int idx = (word << 6) + __builtin_ctzll(free_bits);
+            return idx < cache->max_used ? idx : C_IDX_MASK;
+        }
+    }
+
+    cache->free_hint = word_count;
+    return C_IDX_MASK;
+}
+
+/* Find the first used slot at or after the given index.
+ * Whole words of free slots are skipped, so this costs O(live) rather than O(max_used) for a sparse cache.
+ * Return the index mask if there are no used slots left.
+ */
+static int _next_used_idx(const struct Cache* cache, int idx)
+{
+    if(idx >= cache->max_used)
+    {
+        return C_IDX_MASK;
+    }
+
+    int word = _get_bits_word(idx);
+    int word_count = _get_bits_word_count(cache->max_used);
+
+    // Mask off the slots before the start index in the first word
+    unsigned long long used_bits = cache->used_bits[word] & (~0ull << (idx & 63));
+
+    while(used_bits == 0)
+    {
+        if(++word == word_count)
+        {
+            return C_IDX_MASK;
+        }
+
+        used_bits = cache->used_bits[word];
+    }
+
+    return (word << 6) + __builtin_ctzll(used_bits);
+}
+
+// Bump the key generation of a free slot and mark it valid, returning its new handle
+static int _reuse_slot(struct Cache* cache, int idx)
+{
+    int key = _get_key(cache->handles[idx]);
+
+    ++key;
+    if(key == C_MAX_GENERATIONS)
+    {
+#ifdef DEBUG_CORE_CACHE
+        printf("WARNING: KEY ROLLOVER AT INDEX: %d\n", idx);
+#endif
+        key = 0;
+    }
+
+    // Make entry valid
+    int handle = _make_handle(key, idx);
+    cache->handles[idx] = handle;
+
+    return handle;
+}
+
+// Push a slot onto the head of the LIFO free list
+static void _free_list_push(struct Cache* cache, int idx)
+{
+    // Set invalidated handle to point at what free head is pointing at, or the index mask if the list is empty
+    cache->handles[idx] = _make_handle(_get_key(cache->handles[idx]), _get_idx(cache->free_head));
+    cache->handles[idx] |= C_INVALID_MASK;
+
+    // Set free head to point at invalidated handle
+    cache->free_head = _make_handle(0, idx);
+}
+
+/* Get the next handle index, either from the free slots or open up a new entry.
+ * Free slots are taken from the head of the free list, or the lowest free index, depending on the free policy.
  * If retrieving from the free list, make sure the free list is maintained.
  * Return invalid handle if there is nothing available.
  */
 static int _next_handle(struct Cache* cache)
 {
     int handle = C_NULL_CACHE_HANDLE;
-    int key = C_KEY_MASK;
     int idx = C_IDX_MASK;
 
-    if(!_free_list_empty(cache))
+    if(cache->free_policy == CACHE_FREE_POLICY_LOWEST_FIRST)
+    {
+        if(cache->current_used < cache->max_used)
+        {
+            idx = _find_lowest_free_idx(cache);
+            handle = _reuse_slot(cache, idx);
+        }
+    }
+    else if(!_free_list_empty(cache))
     {
         // Get from free list
         idx = _get_idx(cache->free_head);
-        cache->handles[idx] &= C_VALID_MASK;
-
-        key = _get_key(cache->handles[idx]);
         int next_idx = _get_idx(cache->handles[idx]);
 
-        ++key;
-        if(key == C_MAX_GENERATIONS)
-        {
-#ifdef DEBUG_CORE_CACHE
-            printf("WARNING: KEY ROLLOVER AT INDEX: %d\n", idx);
-#endif
-            key = 0;
-        }
-
-        // Make return handle
-        handle = _make_handle(key, idx);
-
-        // Make entry valid
-        cache->handles[idx] = handle;
+        handle = _reuse_slot(cache, idx);
 
         // Set free head to next node along
         cache->free_head = _make_handle(0, next_idx);
@@ -100,18 +259,18 @@ static int _next_handle(struct Cache* cache)
             cache->free_head |= C_INVALID_MASK;
         }
     }
-    else
+
+    if(idx == C_IDX_MASK)
     {
         if(cache->max_used == cache->capacity)
         {
             return handle;
         }
 
-        // No free list, open up new entry
-        key = 0;
+        // No free slots, open up new entry
         idx = cache->max_used;
 
-        cache->handles[idx] = _make_handle(key, idx);
+        cache->handles[idx] = _make_handle(0, idx);
         cache->handles[idx] &= C_VALID_MASK;
 
         handle = cache->handles[idx];
@@ -119,6 +278,8 @@ static int _next_handle(struct Cache* cache)
         ++cache->max_used;
     }
 
+    _set_used(cache, idx);
+
     return handle;
 }
 
@@ -151,10 +312,52 @@ static bool _check_handle(const struct Cache* cache, int handle)
     return true;
 }
 
+/* Add a single page to a paged cache.
+ * The page table and handles are sized for a power of two number of pages, so they only
+ * need to grow when the page count crosses a power of two. Existing pages never move.
+ */
+static void _add_page(struct Cache* cache)
+{
+    int page_size = 1 << cache->page_shift;
+    int new_page_count = cache->page_count + 1;
+
+    assert((new_page_count << cache->page_shift) - 1 <= C_MAX_CAPACITY && "Paged cache exceeds maximum capacity.");
+
+    if((cache->page_count & (cache->page_count - 1)) == 0)
+    {
+        int new_table_size = cache->page_count << 1;
+        cache->pages = realloc(cache->pages, sizeof(void*) * new_table_size);
+        cache->handles = realloc(cache->handles, sizeof(int) * (new_table_size << cache->page_shift));
+
+        if(!cache->pages || !cache->handles)
+        {
+            abort();
+        }
+    }
+
+    cache->pages[cache->page_count] = malloc(cache->item_size * page_size);
+    if(!cache->pages[cache->page_count])
+    {
+        abort();
+    }
+
+    _init_handles(cache, cache->capacity, cache->capacity + page_size);
+    _resize_used_bits(cache, cache->capacity, cache->capacity + page_size);
+
+    cache->page_count = new_page_count;
+    cache->capacity += page_size;
+}
+
 static void _check_resize(struct Cache* cache)
 {
     if(cache->current_used == cache->capacity)
     {
+        if(cache->pages)
+        {
+            _add_page(cache);
+            return;
+        }
+
         int new_capacity = (cache->capacity << 1);
         cache->items = realloc(cache->items, cache->item_size * new_capacity);
         cache->handles = realloc(cache->handles, sizeof(int) * new_capacity);
@@ -164,6 +367,7 @@ static void _check_resize(struct Cache* cache)
             abort();
         }
 
+        _resize_used_bits(cache, cache->capacity, new_capacity);
         cache->capacity = new_capacity;
     }
 }
@@ -229,19 +433,54 @@ struct Cache* cache_new(int item_size, int capacity, alloc_fn alloc_func, free_f
 void cache_init(struct Cache* cache, int item_size, int capacity, alloc_fn alloc_func, free_fn free_func)
 {
     cache->items        = malloc(capacity * item_size);
+    cache->pages        = NULL;
     cache->handles      = malloc(sizeof(int) * capacity);
     cache->current_used = 0;
     cache->max_used     = 0;
     cache->item_size    = item_size;
     cache->capacity     = capacity;
+    cache->page_shift   = 0;
+    cache->page_count   = 0;
     cache->free_head    = C_NULL_CACHE_HANDLE;
+    cache->free_hint    = 0;
+    cache->free_policy  = CACHE_FREE_POLICY_LIFO;
+    cache->used_bits    = calloc(_get_bits_word_count(cache->capacity), sizeof(unsigned long long));
     cache->alloc_func   = alloc_func;
     cache->free_func    = free_func;
 
-    for(int i = 0; i < cache->capacity; ++i)
-    {
-        cache->handles[i] = C_NULL_CACHE_HANDLE;
-    }
+    _init_handles(cache, 0, cache->capacity);
+}
+
+struct Cache* cache_new_paged(int item_size, int page_capacity, alloc_fn alloc_func, free_fn free_func)
+{
+    assert(page_capacity <= C_MAX_CAPACITY);
+
+    struct Cache* cache = malloc(sizeof(struct Cache));
+    cache_init_paged(cache, item_size, page_capacity, alloc_func, free_func);
+
+    return cache;
+}
+
+void cache_init_paged(struct Cache* cache, int item_size, int page_capacity, alloc_fn alloc_func, free_fn free_func)
+{
+    cache->page_shift   = _get_page_shift(page_capacity > 0 ? page_capacity : 1);
+    cache->page_count   = 1;
+    cache->items        = NULL;
+    cache->pages        = malloc(sizeof(void*));
+    cache->pages[0]     = malloc(item_size << cache->page_shift);
+    cache->capacity     = 1 << cache->page_shift;
+    cache->handles      = malloc(sizeof(int) * cache->capacity);
+    cache->current_used = 0;
+    cache->max_used     = 0;
+    cache->item_size    = item_size;
+    cache->free_head    = C_NULL_CACHE_HANDLE;
+    cache->free_hint    = 0;
+    cache->free_policy  = CACHE_FREE_POLICY_LIFO;
+    cache->used_bits    = calloc(_get_bits_word_count(cache->capacity), sizeof(unsigned long long));
+    cache->alloc_func   = alloc_func;
+    cache->free_func    = free_func;
+
+    _init_handles(cache, 0, cache->capacity);
 }
 
 void cache_free(struct Cache* cache)
@@ -254,16 +493,19 @@ void cache_uninit(struct Cache* cache)
 {
     if(cache->free_func)
     {
-        for(int i = 0; i < cache->max_used; ++i)
+        for(int i = _next_used_idx(cache, 0); i != C_IDX_MASK; i = _next_used_idx(cache, i + 1))
         {
-            int handle = cache->handles[i];
-            if(_check_valid(handle))
-            {
-                cache->free_func(_get_item(cache, handle));
-            }
+            cache->free_func(_get_item(cache, cache->handles[i]));
         }
     }
 
+    for(int i = 0; i < cache->page_count; ++i)
+    {
+        free(cache->pages[i]);
+    }
+
+    free(cache->pages);
+    free(cache->used_bits);
     free(cache->items);
     free(cache->handles);
 }
@@ -278,6 +520,46 @@ int cache_capacity(const struct Cache* cache)
     return cache->capacity;
 }
 
+void cache_set_free_policy(struct Cache* cache, enum CacheFreePolicy free_policy)
+{
+    if(cache->free_policy == free_policy)
+    {
+        return;
+    }
+
+    cache->free_policy = free_policy;
+    cache->free_head = C_NULL_CACHE_HANDLE;
+    cache->free_hint = 0;
+
+    if(free_policy == CACHE_FREE_POLICY_LIFO)
+    {
+        // Rebuild the free list from the used bits, pushing from the top down so the lowest index is the head
+        for(int idx = cache->max_used - 1; idx >= 0; --idx)
+        {
+            if((cache->used_bits[_get_bits_word(idx)] & _get_bits_mask(idx)) == 0)
+            {
+                _free_list_push(cache, idx);
+            }
+        }
+    }
+    else
+    {
+        // Unlink the free list, the used bits already describe the free slots
+        for(int idx = 0; idx < cache->max_used; ++idx)
+        {
+            if(!_check_valid(cache->handles[idx]))
+            {
+                cache->handles[idx] = _make_handle(_get_key(cache->handles[idx]), C_IDX_MASK) | C_INVALID_MASK;
+            }
+        }
+    }
+}
+
+bool cache_is_paged(const struct Cache* cache)
+{
+    return cache->pages != NULL;
+}
+
 int cache_item_size(const struct Cache* cache)
 {
     return cache->item_size;
@@ -341,25 +623,19 @@ void cache_remove(struct Cache* cache, int handle)
         cache->free_func(_get_item(cache, handle));
     }
 
-    if(!_free_list_empty(cache))
+    if(cache->free_policy == CACHE_FREE_POLICY_LOWEST_FIRST)
     {
-        // Set invalidated handle to point at what free head is pointing at
-        cache->handles[handle_idx] = _make_handle(_get_key(cache->handles[handle_idx]), _get_idx(cache->free_head));
+        // Free slots are found through the used bits, so no free list to maintain
+        cache->handles[handle_idx] = _make_handle(_get_key(cache->handles[handle_idx]), C_IDX_MASK);
         cache->handles[handle_idx] |= C_INVALID_MASK;
-
-        // Set free head to point at invalidated handle
-        cache->free_head = _make_handle(0, handle_idx);
     }
     else
     {
-        // Set invalidated handle to point at index mask
-        cache->handles[handle_idx] = _make_handle(_get_key(cache->handles[handle_idx]), C_IDX_MASK);
-        cache->handles[handle_idx] |= C_INVALID_MASK;
-
-        // Set free head to point at invalidated handle
-        cache->free_head = _make_handle(0, handle_idx);
+        _free_list_push(cache, handle_idx);
     }
 
+    _set_unused(cache, handle_idx);
+
     --cache->current_used;
 }
 
@@ -394,19 +670,15 @@ struct CacheIt cache_end(struct Cache* cache)
 
 struct CacheIt cache_it_next(struct CacheIt it)
 {
-    ++it.current_idx;
+    int next_idx = _next_used_idx(it.cache, it.current_idx + 1);
 
-    while(it.current_idx < it.cache->max_used)
+    if(next_idx == C_IDX_MASK)
     {
-        if(_check_valid(it.cache->handles[it.current_idx]))
-        {
-            return it;
-        }
-
-        ++it.current_idx;
+        return cache_end(it.cache);
     }
 
-    return cache_end(it.cache);
+    it.current_idx = next_idx;
+    return it;
 }
 
 bool cache_it_eq(struct CacheIt lhs, struct CacheIt rhs)
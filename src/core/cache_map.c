@@ -6,100 +6,431 @@
 #include <stdlib.h>
 #include <string.h>
 
-static const int C_DEFAULT_BUCKET_COUNT = 16;
-static const int C_DEFAULT_BUCKET_CAPACITY = 16;
-static const float C_CACHE_MAP_LOAD_FACTOR_THRESHOLD = 0.75f;
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static const signed char C_CTRL_EMPTY   = -128; // 0b10000000
+static const signed char C_CTRL_DELETED = -2;   // 0b11111110
+static const int         C_H2_MASK      = 0x7f;
+static const int         C_H1_SHIFT     = 7;
 
 // INTERNAL FUNCS
 
-static inline int _get_bucket_index(int hashed_key, int bucket_count)
+// Hash bits that pick the group to start probing from
+static inline unsigned long long _h1(unsigned long long key_hash)
+{
+    return key_hash >> C_H1_SHIFT;
+}
+
+// Hash bits stored in the control byte of a full slot
+static inline signed char _h2(unsigned long long key_hash)
+{
+    return (signed char)(key_hash & C_H2_MASK);
+}
+
+static inline const char* _slot_key(const struct CacheMapSlot* slot)
+{
+    return slot->key_bytes <= CACHE_MAP_INLINE_KEY_BYTES ? slot->inline_key : slot->key;
+}
+
+static inline bool _slot_key_equal(const struct CacheMapSlot* slot, const void* key, int key_bytes, unsigned long long key_hash)
+{
+    return slot->hash == key_hash &&
+           slot->key_bytes == key_bytes &&
+           memcmp(_slot_key(slot), key, key_bytes) == 0;
+}
+
+// Copy the key into the slot, allocating if it is too big to store inline
+static void _slot_set_key(struct CacheMapSlot* slot, const void* key, int key_bytes, unsigned long long key_hash)
 {
-    return hashed_key & (bucket_count - 1);
+    slot->hash = key_hash;
+    slot->key_bytes = key_bytes;
+
+    if(key_bytes <= CACHE_MAP_INLINE_KEY_BYTES)
+    {
+        memcpy(slot->inline_key, key, key_bytes);
+    }
+    else
+    {
+        slot->key = malloc(key_bytes);
+        memcpy(slot->key, key, key_bytes);
+    }
 }
 
-static inline int _get_bucket_item_index(int bucket_index, int item_offset, int bucket_capacity)
+static void _slot_free_key(struct CacheMapSlot* slot)
 {
-    return (bucket_index * bucket_capacity) + item_offset;
+    if(slot->key_bytes > CACHE_MAP_INLINE_KEY_BYTES)
+    {
+        free(slot->key);
+    }
+
+    slot->key_bytes = 0;
+}
+
+static inline bool _ctrl_is_full(signed char ctrl)
+{
+    return ctrl >= 0;
 }
 
-// Search a bucket for the item
-static inline struct CacheMapBucketItem* _get_bucket_item(struct CacheMapBucketItem* bucket_items, int hashed_key, int bucket_count, int bucket_capacity)
+static inline int _group_count(int slot_count)
+{
+    return slot_count / CACHE_MAP_GROUP_WIDTH;
+}
+
+// Max number of slots that can be full or deleted before the table must grow
+static inline int _max_load(int slot_count)
+{
+    return slot_count - (slot_count >> 3);
+}
+
+#if defined(__SSE2__)
+
+// Returns a bitmask of the slots in the group whose control byte equals the given value
+static inline unsigned int _group_match(const signed char* group, signed char value)
+{
+    __m128i ctrl = _mm_load_si128((const __m128i*)group);
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(value)));
+}
+
+// Returns a bitmask of the slots in the group that are empty or deleted
+static inline unsigned int _group_match_free(const signed char* group)
+{
+    // Empty and deleted are the only control bytes with the high bit set
+    __m128i ctrl = _mm_load_si128((const __m128i*)group);
+    return (unsigned int)_mm_movemask_epi8(ctrl);
+}
+
+#else
+
+// Returns a bitmask of the slots in the group whose control byte equals the given value
+static inline unsigned int _group_match(const signed char* group, signed char value)
+{
+    unsigned int mask = 0;
+    for(int i = 0; i < CACHE_MAP_GROUP_WIDTH; ++i)
+    {
+        mask |= (unsigned int)(group[i] == value) << i;
+    }
+
+    return mask;
+}
+
+// Returns a bitmask of the slots in the group that are empty or deleted
+static inline unsigned int _group_match_free(const signed char* group)
+{
+    unsigned int mask = 0;
+    for(int i = 0; i < CACHE_MAP_GROUP_WIDTH; ++i)
+    {
+        mask |= (unsigned int)(group[i] < 0) << i;
+    }
+
+    return mask;
+}
+
+#endif
+
+/* Find the slot in the table holding the key.
+ * Probes one group at a time, stopping at the first group with an empty slot.
+ * Returns -1 if the key is not in the table.
+ */
+static int _find_slot(const struct CacheMapTable* table, const void* key, int key_bytes, unsigned long long key_hash)
 {
-    int bucket_idx = _get_bucket_index(hashed_key, bucket_count);
-    for(int item_idx = 0; item_idx < bucket_capacity; ++item_idx)
+    if(table->slot_count == 0)
     {
-        struct CacheMapBucketItem* item = &bucket_items[_get_bucket_item_index(bucket_idx, item_idx, bucket_capacity)];
-        if(item->key == hashed_key)
+        return -1;
+    }
+
+    signed char h2 = _h2(key_hash);
+    int group_mask = _group_count(table->slot_count) - 1;
+    int group_idx = _h1(key_hash) & group_mask;
+
+    // Triangular probing visits every group once when the group count is a power of two
+    for(int probe = 1; probe <= group_mask + 1; ++probe)
+    {
+        const signed char* group = &table->ctrl[group_idx * CACHE_MAP_GROUP_WIDTH];
+
+        for(unsigned int match = _group_match(group, h2); match != 0; match &= match - 1)
         {
-            return item;
+            int slot_idx = (group_idx * CACHE_MAP_GROUP_WIDTH) + __builtin_ctz(match);
+            if(_slot_key_equal(&table->slots[slot_idx], key, key_bytes, key_hash))
+            {
+                return slot_idx;
+            }
         }
+
+        if(_group_match(group, C_CTRL_EMPTY) != 0)
+        {
+            return -1;
+        }
+
+        group_idx = (group_idx + probe) & group_mask;
     }
 
-    return NULL;
+    return -1;
+}
+
+// Find the first empty or deleted slot on the key's probe sequence
+static int _find_free_slot(const struct CacheMapTable* table, unsigned long long key_hash)
+{
+    int group_mask = _group_count(table->slot_count) - 1;
+    int group_idx = _h1(key_hash) & group_mask;
+
+    for(int probe = 1; ; ++probe)
+    {
+        unsigned int match = _group_match_free(&table->ctrl[group_idx * CACHE_MAP_GROUP_WIDTH]);
+        if(match != 0)
+        {
+            return (group_idx * CACHE_MAP_GROUP_WIDTH) + __builtin_ctz(match);
+        }
+
+        group_idx = (group_idx + probe) & group_mask;
+    }
 }
 
-static inline struct CacheMapBucketItem* _get_next_bucket_item(struct CacheMapBucketItem* bucket_items, int hashed_key, int bucket_count, int bucket_capacity)
+static void _init_table(struct CacheMapTable* table, int slot_count)
 {
-    // First check if this key already exists, if it does then we must reuse it.
-    struct CacheMapBucketItem* item = _get_bucket_item(bucket_items, hashed_key, bucket_count, bucket_capacity);
-    if (item != NULL)
+    table->slot_count = slot_count;
+    table->growth_left = _max_load(slot_count);
+    table->ctrl = aligned_alloc(CACHE_MAP_GROUP_WIDTH, slot_count);
+    table->slots = malloc(slot_count * sizeof(struct CacheMapSlot));
+
+    if(!table->ctrl || !table->slots)
     {
-        return item;
+        abort();
     }
 
-    // Key doesn't exist, so find a free spot
-    int bucket_idx = _get_bucket_index(hashed_key, bucket_count);
-    for(int item_idx = 0; item_idx < bucket_capacity; ++item_idx)
+    memset(table->ctrl, C_CTRL_EMPTY, slot_count);
+}
+
+// Free the table's keys and storage, leaving it empty
+static void _uninit_table(struct CacheMapTable* table)
+{
+    for(int i = 0; i < table->slot_count; ++i)
     {
-        struct CacheMapBucketItem* item = &bucket_items[_get_bucket_item_index(bucket_idx, item_idx, bucket_capacity)];
-        if(item->handle == C_NULL_CACHE_HANDLE)
+        if(_ctrl_is_full(table->ctrl[i]))
         {
-            return item;
+            _slot_free_key(&table->slots[i]);
         }
     }
 
-    return NULL;
+    free(table->ctrl);
+    free(table->slots);
+    table->ctrl = NULL;
+    table->slots = NULL;
+    table->slot_count = 0;
+    table->growth_left = 0;
 }
 
-static inline float _load_factor(int item_count, int bucket_count)
+static inline bool _is_migrating(const struct CacheMap* map)
 {
-    return (float)item_count / (float)bucket_count;
+    return map->old_table.slot_count > 0;
 }
 
-static inline void _init_cache(struct CacheMapBucketItem* bucket_items, int bucket_count, int bucket_capacity)
+/* Move a full slot from the old table into the new table and return its new index.
+ * The old slot becomes a tombstone rather than empty, so probes for keys still in the old table
+ * keep walking past it.
+ */
+static int _migrate_slot(struct CacheMap* map, int old_idx)
 {
-    for(int i = 0; i < bucket_count * bucket_capacity; ++i)
+    struct CacheMapTable* old_table = &map->old_table;
+    struct CacheMapTable* table = &map->table;
+
+    int new_idx = _find_free_slot(table, old_table->slots[old_idx].hash);
+    if(table->ctrl[new_idx] == C_CTRL_EMPTY)
     {
-        struct CacheMapBucketItem* item = &bucket_items[i];
-        item->key = -1;
-        item->handle = C_NULL_CACHE_HANDLE;
+        --table->growth_left;
     }
+
+    table->ctrl[new_idx] = old_table->ctrl[old_idx];
+    table->slots[new_idx] = old_table->slots[old_idx];
+
+    old_table->ctrl[old_idx] = C_CTRL_DELETED;
+    old_table->slots[old_idx].key_bytes = 0;
+
+    return new_idx;
 }
 
-static inline bool _need_resize(struct CacheMap* map)
+/* Move up to slot_budget slots of the old table into the new table.
+ * Frees the old table once every slot has been visited.
+ */
+static void _migrate(struct CacheMap* map, int slot_budget)
 {
-    return _load_factor(cache_size(&map->cache), map->bucket_count) > C_CACHE_MAP_LOAD_FACTOR_THRESHOLD;
+    if(!_is_migrating(map))
+    {
+        return;
+    }
+
+    int end_idx = map->migrate_idx + slot_budget;
+    if(end_idx > map->old_table.slot_count)
+    {
+        end_idx = map->old_table.slot_count;
+    }
+
+    for(; map->migrate_idx < end_idx; ++map->migrate_idx)
+    {
+        if(_ctrl_is_full(map->old_table.ctrl[map->migrate_idx]))
+        {
+            _migrate_slot(map, map->migrate_idx);
+        }
+    }
+
+    if(map->migrate_idx == map->old_table.slot_count)
+    {
+        _uninit_table(&map->old_table);
+        map->migrate_idx = 0;
+    }
 }
 
+/* Start growing into a fresh table.
+ * Doubles the slot count unless most of the used slots are tombstones, in which case
+ * rehashing at the same size is enough to reclaim them.
+ * The current table becomes the old table, and is migrated a few slots at a time by later adds
+ * and removes. Any migration still in progress is finished first.
+ */
 static void _resize(struct CacheMap* map)
 {
-    int new_bucket_count = map->bucket_count << 1;
+    _migrate(map, map->old_table.slot_count);
+
+    int new_slot_count = map->table.slot_count;
+    if(cache_size(&map->cache) * 2 > _max_load(new_slot_count))
+    {
+        new_slot_count <<= 1;
+    }
 
-    struct CacheMapBucketItem* new_bucket_items = malloc(new_bucket_count * map->bucket_capacity * sizeof(struct CacheMapBucketItem));
+    map->old_table = map->table;
+    map->migrate_idx = 0;
+    _init_table(&map->table, new_slot_count);
 
-    _init_cache(new_bucket_items, new_bucket_count, map->bucket_capacity);
+    _migrate(map, CACHE_MAP_MIGRATE_SLOTS);
+}
+
+/* Find the slot in the new table to put a key into, growing the table if needed.
+ * If the key is already in the map, its slot is returned with the old handle still in place.
+ */
+static int _prepare_insert(struct CacheMap* map, const void* key, int key_bytes, unsigned long long key_hash)
+{
+    _migrate(map, CACHE_MAP_MIGRATE_SLOTS);
 
-    // Rehash
-    for(int i = 0; i < map->bucket_count * map->bucket_capacity; ++i)
+    struct CacheMapTable* table = &map->table;
+
+    int slot_idx = _find_slot(table, key, key_bytes, key_hash);
+    if(slot_idx != -1)
     {
-        struct CacheMapBucketItem* old_item = &map->bucket_items[i];
-        struct CacheMapBucketItem* new_item = _get_next_bucket_item(new_bucket_items, old_item->key, new_bucket_count, map->bucket_capacity);
-        *new_item = *old_item;
+        return slot_idx;
     }
 
-    free(map->bucket_items);
-    map->bucket_items = new_bucket_items;
-    map->bucket_count = new_bucket_count;
+    slot_idx = _find_slot(&map->old_table, key, key_bytes, key_hash);
+    if(slot_idx != -1)
+    {
+        return _migrate_slot(map, slot_idx);
+    }
+
+    slot_idx = _find_free_slot(table, key_hash);
+
+    // Reusing a tombstone does not use up any growth
+    if(table->growth_left == 0 && table->ctrl[slot_idx] != C_CTRL_DELETED)
+    {
+        _resize(map);
+        slot_idx = _find_free_slot(table, key_hash);
+    }
+
+    if(table->ctrl[slot_idx] == C_CTRL_EMPTY)
+    {
+        --table->growth_left;
+    }
+
+    table->ctrl[slot_idx] = _h2(key_hash);
+    table->slots[slot_idx].handle = C_NULL_CACHE_HANDLE;
+    _slot_set_key(&table->slots[slot_idx], key, key_bytes, key_hash);
+
+    return slot_idx;
+}
+
+/* Mark a slot as no longer holding a key.
+ * If the slot's group still has an empty slot then no probe can have passed through it, so the
+ * slot can go straight back to empty. Otherwise it must become a tombstone.
+ */
+static void _erase_slot(struct CacheMapTable* table, int slot_idx)
+{
+    const signed char* group = &table->ctrl[(slot_idx / CACHE_MAP_GROUP_WIDTH) * CACHE_MAP_GROUP_WIDTH];
+
+    if(_group_match(group, C_CTRL_EMPTY) != 0)
+    {
+        table->ctrl[slot_idx] = C_CTRL_EMPTY;
+        ++table->growth_left;
+    }
+    else
+    {
+        table->ctrl[slot_idx] = C_CTRL_DELETED;
+    }
+
+    table->slots[slot_idx].handle = C_NULL_CACHE_HANDLE;
+    _slot_free_key(&table->slots[slot_idx]);
+}
+
+// Remove the item held by a slot, then erase the slot
+static void _remove_slot(struct CacheMap* map, struct CacheMapTable* table, int slot_idx)
+{
+    cache_remove(&map->cache, table->slots[slot_idx].handle);
+    _erase_slot(table, slot_idx);
+}
+
+// Put an item into a slot of the new table, replacing any item it already holds
+static void* _slot_emplace(struct CacheMap* map, int slot_idx, const void* args)
+{
+    struct CacheMapSlot* slot = &map->table.slots[slot_idx];
+
+    if(slot->handle != C_NULL_CACHE_HANDLE)
+    {
+        cache_remove(&map->cache, slot->handle);
+    }
+
+    slot->handle = cache_emplace(&map->cache, args);
+
+    return cache_get(&map->cache, slot->handle);
+}
+
+// Find the slot holding the key in either table
+static const struct CacheMapSlot* _find_any_slot(const struct CacheMap* map, const void* key, int key_bytes, unsigned long long key_hash)
+{
+    int slot_idx = _find_slot(&map->table, key, key_bytes, key_hash);
+    if(slot_idx != -1)
+    {
+        return &map->table.slots[slot_idx];
+    }
+
+    slot_idx = _find_slot(&map->old_table, key, key_bytes, key_hash);
+    if(slot_idx != -1)
+    {
+        return &map->old_table.slots[slot_idx];
+    }
+
+    return NULL;
+}
+
+// Get the table and the index into it for an iterator index, which runs over the new table then the old
+static inline const struct CacheMapTable* _it_table(const struct CacheMap* map, int index, int* slot_idx)
+{
+    if(index < map->table.slot_count)
+    {
+        *slot_idx = index;
+        return &map->table;
+    }
+
+    *slot_idx = index - map->table.slot_count;
+    return &map->old_table;
+}
+
+// Smallest power of two slot count that holds the capacity without growing
+static int _get_slot_count(int capacity)
+{
+    int slot_count = CACHE_MAP_GROUP_WIDTH;
+    while(_max_load(slot_count) < capacity)
+    {
+        slot_count <<= 1;
+    }
+
+    return slot_count;
 }
 
 // EXTERNAL FUNCS
@@ -122,18 +453,18 @@ void cache_map_free(struct CacheMap* map)
 void cache_map_init(struct CacheMap* map, int item_size, int capacity, alloc_fn alloc_func, free_fn free_func)
 {
     map->item_size = item_size;
-    map->bucket_count = C_DEFAULT_BUCKET_COUNT;
-    map->bucket_capacity = C_DEFAULT_BUCKET_CAPACITY;
-    map->bucket_items = malloc(map->bucket_capacity * map->bucket_count * sizeof(struct CacheMapBucketItem));
-    _init_cache(map->bucket_items, map->bucket_count, map->bucket_capacity);
-    cache_init(&map->cache, map->item_size, capacity, alloc_func, free_func);
+    map->migrate_idx = 0;
+    _init_table(&map->table, _get_slot_count(capacity));
+    map->old_table = (struct CacheMapTable){ 0, 0, NULL, NULL };
+    cache_init_paged(&map->cache, map->item_size, capacity, alloc_func, free_func);
 }
 
 void cache_map_uninit(struct CacheMap* map)
 {
+    _uninit_table(&map->table);
+    _uninit_table(&map->old_table);
     cache_uninit(&map->cache);
-    free(map->bucket_items);
-    map->bucket_count = 0;
+    map->migrate_idx = 0;
     map->item_size = 0;
 }
 
@@ -146,43 +477,37 @@ int cache_map_count(const struct CacheMap* map)
 
 void* cache_map_get(const struct CacheMap* map, const void* key, int key_bytes)
 {
-    int hashed_key = hash(key, key_bytes);
-    return cache_map_get_hashed(map, hashed_key);
+    return cache_map_get_with_hash(map, key, key_bytes, hash64(key, key_bytes));
 }
 
 void* cache_map_get_hashed(const struct CacheMap* map, int hashed_key)
 {
-    struct CacheMapBucketItem* bucket_item = _get_bucket_item(map->bucket_items, hashed_key, map->bucket_count, map->bucket_capacity);
+    return cache_map_get(map, &hashed_key, sizeof(int));
+}
+
+void* cache_map_get_with_hash(const struct CacheMap* map, const void* key, int key_bytes, unsigned long long key_hash)
+{
+    const struct CacheMapSlot* slot = _find_any_slot(map, key, key_bytes, key_hash);
 
-    if(bucket_item == NULL)
+    if(slot == NULL)
     {
         return NULL;
     }
 
-    void* data = cache_get(&map->cache, bucket_item->handle);
-
-    return data;
+    return cache_get(&map->cache, slot->handle);
 }
 
 float cache_map_load_factor(const struct CacheMap* map)
 {
-    return _load_factor(cache_size(&map->cache), map->bucket_count) > C_CACHE_MAP_LOAD_FACTOR_THRESHOLD;
+    return (float)cache_size(&map->cache) / (float)map->table.slot_count;
 }
 
 struct It cache_map_begin(struct CacheMap* map)
 {
     struct It it;
     it.container = map;
-
-    for(it.index = 0; it.index < (map->bucket_count * map->bucket_capacity); ++it.index)
-    {
-        struct CacheMapBucketItem* item = &map->bucket_items[it.index];
-        if(item->handle != C_NULL_CACHE_HANDLE)
-        {
-            break;
-        }
-    }
-
+    it.index = -1;
+    cache_map_it_next(&it);
     return it;
 }
 
@@ -190,18 +515,20 @@ struct It cache_map_end(struct CacheMap* map)
 {
     struct It it;
     it.container = map;
-    it.index = map->bucket_count * map->bucket_capacity;
+    it.index = map->table.slot_count + map->old_table.slot_count;
     return it;
 }
 
 void cache_map_it_next(struct It* it)
 {
     struct CacheMap* map = it->container;
+    int end_idx = map->table.slot_count + map->old_table.slot_count;
 
-    for(++it->index; it->index < (map->bucket_count * map->bucket_capacity); ++it->index)
+    for(++it->index; it->index < end_idx; ++it->index)
     {
-        struct CacheMapBucketItem* item = &map->bucket_items[it->index];
-        if(item->handle != C_NULL_CACHE_HANDLE)
+        int slot_idx;
+        const struct CacheMapTable* table = _it_table(map, it->index, &slot_idx);
+        if(_ctrl_is_full(table->ctrl[slot_idx]))
         {
             return;
         }
@@ -211,102 +538,89 @@ void cache_map_it_next(struct It* it)
 void* cache_map_it_get(const struct It* it)
 {
     struct CacheMap* map = it->container;
-    struct CacheMapBucketItem* bucket_item = &map->bucket_items[it->index];
-    void* data = cache_get(&map->cache, bucket_item->handle);
-    return data;
+
+    int slot_idx;
+    const struct CacheMapTable* table = _it_table(map, it->index, &slot_idx);
+    return cache_get(&map->cache, table->slots[slot_idx].handle);
 }
 
 // MUTATORS
 
 void cache_map_add(struct CacheMap* map, const void* key, int key_bytes, const void* item)
 {
-    if(_need_resize(map))
-    {
-        _resize(map);
-    }
-
-    int hashed_key = hash(key, key_bytes);
-    struct CacheMapBucketItem* new_bucket_item = _get_next_bucket_item(map->bucket_items, hashed_key, map->bucket_count, map->bucket_capacity);
-
-    if(new_bucket_item == NULL)
-    {
-        _resize(map);
-        new_bucket_item = _get_next_bucket_item(map->bucket_items, hashed_key, map->bucket_count, map->bucket_capacity);
-    }
+    int slot_idx = _prepare_insert(map, key, key_bytes, hash64(key, key_bytes));
+    struct CacheMapSlot* slot = &map->table.slots[slot_idx];
 
-    if(new_bucket_item->handle != C_NULL_CACHE_HANDLE)
+    if(slot->handle != C_NULL_CACHE_HANDLE)
     {
-        cache_remove(&map->cache, new_bucket_item->handle);
+        cache_remove(&map->cache, slot->handle);
     }
 
-    int item_h = cache_add(&map->cache, item);
-    new_bucket_item->key = hashed_key;
-    new_bucket_item->handle = item_h;
+    slot->handle = cache_add(&map->cache, item);
 }
 
 void cache_map_clear(struct CacheMap* map)
 {
-    for(int i = 0; i < (map->bucket_count * map->bucket_capacity); ++i)
+    struct CacheMapTable* table = &map->table;
+
+    for(int i = 0; i < table->slot_count; ++i)
     {
-        struct CacheMapBucketItem* bucket = &map->bucket_items[i];
-        if(bucket->handle != C_NULL_CACHE_HANDLE)
+        if(_ctrl_is_full(table->ctrl[i]))
         {
-            cache_remove(&map->cache, bucket->handle);
+            cache_remove(&map->cache, table->slots[i].handle);
+            _slot_free_key(&table->slots[i]);
         }
+    }
 
-        bucket->key = -1;
-        bucket->handle = C_NULL_CACHE_HANDLE;
+    memset(table->ctrl, C_CTRL_EMPTY, table->slot_count);
+    table->growth_left = _max_load(table->slot_count);
+
+    struct CacheMapTable* old_table = &map->old_table;
+
+    for(int i = 0; i < old_table->slot_count; ++i)
+    {
+        if(_ctrl_is_full(old_table->ctrl[i]))
+        {
+            cache_remove(&map->cache, old_table->slots[i].handle);
+        }
     }
+
+    _uninit_table(old_table);
+    map->migrate_idx = 0;
 }
 
 void* cache_map_emplace(struct CacheMap* map, const void* key, int key_bytes, const void* args)
 {
-    if(_need_resize(map))
-    {
-        _resize(map);
-    }
-
-    int hashed_key = hash(key, key_bytes);
-    return cache_map_emplace_hashed(map, hashed_key, args);
+    return cache_map_emplace_with_hash(map, key, key_bytes, hash64(key, key_bytes), args);
 }
 
 void* cache_map_emplace_hashed(struct CacheMap* map, const int hashed_key, const void* args)
 {
-    if(_need_resize(map))
-    {
-        _resize(map);
-    }
-
-    struct CacheMapBucketItem* new_bucket_item = _get_next_bucket_item(map->bucket_items, hashed_key, map->bucket_count, map->bucket_capacity);
-    if(new_bucket_item == NULL)
-    {
-        _resize(map);
-        new_bucket_item = _get_next_bucket_item(map->bucket_items, hashed_key, map->bucket_count, map->bucket_capacity);
-    }
-
-    if(new_bucket_item->handle != C_NULL_CACHE_HANDLE)
-    {
-        cache_remove(&map->cache, new_bucket_item->handle);
-    }
-
-    int item_h = cache_emplace(&map->cache, args);
-    new_bucket_item->key = hashed_key;
-    new_bucket_item->handle = item_h;
+    return cache_map_emplace(map, &hashed_key, sizeof(int), args);
+}
 
-    return cache_map_get_hashed(map, hashed_key);
+void* cache_map_emplace_with_hash(struct CacheMap* map, const void* key, int key_bytes, unsigned long long key_hash, const void* args)
+{
+    int slot_idx = _prepare_insert(map, key, key_bytes, key_hash);
+    return _slot_emplace(map, slot_idx, args);
 }
 
 void cache_map_remove(struct CacheMap* map, const void* key, int key_bytes)
 {
-    int hashed_key = hash(key, key_bytes);
-    struct CacheMapBucketItem* bucket_item = _get_bucket_item(map->bucket_items, hashed_key, map->bucket_count, map->bucket_capacity);
-    if(!bucket_item)
+    unsigned long long key_hash = hash64(key, key_bytes);
+
+    _migrate(map, CACHE_MAP_MIGRATE_SLOTS);
+
+    int slot_idx = _find_slot(&map->table, key, key_bytes, key_hash);
+    if(slot_idx != -1)
     {
+        _remove_slot(map, &map->table, slot_idx);
         return;
     }
 
-    cache_remove(&map->cache, bucket_item->handle);
-
-    bucket_item->handle = C_NULL_CACHE_HANDLE;
-    bucket_item->key = -1;
+    slot_idx = _find_slot(&map->old_table, key, key_bytes, key_hash);
+    if(slot_idx != -1)
+    {
+        _remove_slot(map, &map->old_table, slot_idx);
+    }
 }
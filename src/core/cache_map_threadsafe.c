@@ -0,0 +1,136 @@
+#include "scieppend/core/cache_map_threadsafe.h"
+
+#include <stdlib.h>
+
+struct CacheMap_ThreadSafe* cache_map_ts_new(int item_size, int capacity, alloc_fn alloc_func, free_fn free_func)
+{
+    struct CacheMap_ThreadSafe* map = malloc(sizeof(struct CacheMap_ThreadSafe));
+    cache_map_ts_init(map, item_size, capacity, alloc_func, free_func);
+    return map;
+}
+
+void cache_map_ts_free(struct CacheMap_ThreadSafe* map)
+{
+    cache_map_ts_uninit(map);
+    free(map);
+}
+
+void cache_map_ts_init(struct CacheMap_ThreadSafe* map, int item_size, int capacity, alloc_fn alloc_func, free_fn free_func)
+{
+    rwlock_init(&map->lock);
+    rwlock_write_lock(&map->lock);
+    cache_map_init(&map->map, item_size, capacity, alloc_func, free_func);
+    rwlock_write_unlock(&map->lock);
+}
+
+void cache_map_ts_uninit(struct CacheMap_ThreadSafe* map)
+{
+    rwlock_write_lock(&map->lock);
+    cache_map_uninit(&map->map);
+    rwlock_write_unlock(&map->lock);
+    rwlock_uninit(&map->lock);
+}
+
+int cache_map_ts_count(const struct CacheMap_ThreadSafe* map)
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
+    rwlock_read_lock(&map->lock);
+    int ret = cache_map_count(&map->map);
+    rwlock_read_unlock(&map->lock);
+    return ret;
+#pragma GCC diagnostic pop
+}
+
+void* cache_map_ts_get(const struct CacheMap_ThreadSafe* map, const void* key, int key_bytes)
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
+    rwlock_read_lock(&map->lock);
+    void* ret = cache_map_get(&map->map, key, key_bytes);
+    rwlock_read_unlock(&map->lock);
+    return ret;
+#pragma GCC diagnostic pop
+}
+
+void* cache_map_ts_get_hashed(const struct CacheMap_ThreadSafe* map, int hashed_key)
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
+    rwlock_read_lock(&map->lock);
+    void* ret = cache_map_get_hashed(&map->map, hashed_key);
+    rwlock_read_unlock(&map->lock);
+    return ret;
+#pragma GCC diagnostic pop
+}
+
+void* cache_map_ts_get_with_hash(const struct CacheMap_ThreadSafe* map, const void* key, int key_bytes, unsigned long long key_hash)
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
+    rwlock_read_lock(&map->lock);
+    void* ret = cache_map_get_with_hash(&map->map, key, key_bytes, key_hash);
+    rwlock_read_unlock(&map->lock);
+    return ret;
+#pragma GCC diagnostic pop
+}
+
+void cache_map_ts_add(struct CacheMap_ThreadSafe* map, const void* key, int key_bytes, const void* item)
+{
+    rwlock_write_lock(&map->lock);
+    cache_map_add(&map->map, key, key_bytes, item);
+    rwlock_write_unlock(&map->lock);
+}
+
+void cache_map_ts_clear(struct CacheMap_ThreadSafe* map)
+{
+    rwlock_write_lock(&map->lock);
+    cache_map_clear(&map->map);
+    rwlock_write_unlock(&map->lock);
+}
+
+void* cache_map_ts_emplace(struct CacheMap_ThreadSafe* map, const void* key, int key_bytes, const void* args)
+{
+    rwlock_write_lock(&map->lock);
+    void* ret = cache_map_emplace(&map->map, key, key_bytes, args);
+    rwlock_write_unlock(&map->lock);
+    return ret;
+}
+
+void* cache_map_ts_emplace_hashed(struct CacheMap_ThreadSafe* map, const int hashed_key, const void* args)
+{
+    rwlock_write_lock(&map->lock);
+    void* ret = cache_map_emplace_hashed(&map->map, hashed_key, args);
+    rwlock_write_unlock(&map->lock);
+    return ret;
+}
+
+void cache_map_ts_remove(struct CacheMap_ThreadSafe* map, const void* key, int key_bytes)
+{
+    rwlock_write_lock(&map->lock);
+    cache_map_remove(&map->map, key, key_bytes);
+    rwlock_write_unlock(&map->lock);
+}
+
+bool cache_map_ts_lock(const struct CacheMap_ThreadSafe* map, bool write)
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
+    return write ? rwlock_write_lock(&map->lock) : rwlock_read_lock(&map->lock);
+#pragma GCC diagnostic pop
+}
+
+void cache_map_ts_unlock(const struct CacheMap_ThreadSafe* map, bool write)
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
+    if(write)
+    {
+        rwlock_write_unlock(&map->lock);
+    }
+    else
+    {
+        rwlock_read_unlock(&map->lock);
+    }
+#pragma GCC diagnostic pop
+}
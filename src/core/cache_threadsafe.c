@@ -17,6 +17,21 @@ void cache_ts_init(struct Cache_ThreadSafe* cache, int item_size, int capacity,
     rwlock_write_unlock(&cache->lock);
 }
 
+struct Cache_ThreadSafe* cache_ts_new_paged(int item_size, int page_capacity, alloc_fn alloc_func, free_fn free_func)
+{
+    struct Cache_ThreadSafe* cache = malloc(sizeof(struct Cache_ThreadSafe));
+    cache_ts_init_paged(cache, item_size, page_capacity, alloc_func, free_func);
+    return cache;
+}
+
+void cache_ts_init_paged(struct Cache_ThreadSafe* cache, int item_size, int page_capacity, alloc_fn alloc_func, free_fn free_func)
+{
+    rwlock_init(&cache->lock);
+    rwlock_write_lock(&cache->lock);
+    cache_init_paged(&cache->cache, item_size, page_capacity, alloc_func, free_func);
+    rwlock_write_unlock(&cache->lock);
+}
+
 void cache_ts_free(struct Cache_ThreadSafe* cache)
 {
     cache_ts_uninit(cache);
@@ -75,6 +90,13 @@ int cache_ts_used(const struct Cache_ThreadSafe* cache)
 #pragma GCC diagnostic pop
 }
 
+void cache_ts_set_free_policy(struct Cache_ThreadSafe* cache, enum CacheFreePolicy free_policy)
+{
+    rwlock_write_lock(&cache->lock);
+    cache_set_free_policy(&cache->cache, free_policy);
+    rwlock_write_unlock(&cache->lock);
+}
+
 bool cache_ts_stale_handle(const struct Cache_ThreadSafe* cache, int handle)
 {
 #pragma GCC diagnostic push
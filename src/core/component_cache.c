@@ -19,8 +19,12 @@ struct ComponentCache* component_cache_new(ComponentTypeHandle type_handle, int
 void component_cache_init(struct ComponentCache* component_cache, ComponentTypeHandle type_handle, int bytes, int capacity, alloc_fn alloc_func, free_fn free_func)
 {
     component_cache->component_type_handle = type_handle;
-    cache_ts_init(&component_cache->components, bytes, capacity, alloc_func, free_func);
-    cache_init(&component_cache->component_locks, sizeof(struct RWLock), capacity, rwlock_init_wrapper, rwlock_uninit_wrapper);
+    cache_ts_init_paged(&component_cache->components, bytes, capacity, alloc_func, free_func);
+    cache_init_paged(&component_cache->component_locks, sizeof(struct RWLock), capacity, rwlock_init_wrapper, rwlock_uninit_wrapper);
+
+    // Keep components packed under churn. Both caches must use the same policy so their handles match.
+    cache_ts_set_free_policy(&component_cache->components, CACHE_FREE_POLICY_LOWEST_FIRST);
+    cache_set_free_policy(&component_cache->component_locks, CACHE_FREE_POLICY_LOWEST_FIRST);
     event_init(&component_cache->component_added_event);
     event_init(&component_cache->component_removed_event);
 }
@@ -107,16 +111,16 @@ void component_cache_unlock_component(const struct ComponentCache* component_cac
     cache_ts_unlock(&component_cache->components, READ);
 }
 
-void component_cache_register_observer(struct ComponentCache* component_cache, const ObserverHandle observer_handle)
+void component_cache_register_observers(struct ComponentCache* component_cache, const ObserverHandle added_observer, const ObserverHandle removed_observer)
 {
-    event_register_observer(&component_cache->component_added_event, observer_handle);
-    event_register_observer(&component_cache->component_removed_event, observer_handle);
+    event_register_observer(&component_cache->component_added_event, added_observer);
+    event_register_observer(&component_cache->component_removed_event, removed_observer);
 }
 
-void component_cache_deregister_observer(struct ComponentCache* component_cache, const ObserverHandle observer_handle)
+void component_cache_deregister_observers(struct ComponentCache* component_cache, const ObserverHandle added_observer, const ObserverHandle removed_observer)
 {
-    event_deregister_observer(&component_cache->component_added_event, observer_handle);
-    event_deregister_observer(&component_cache->component_removed_event, observer_handle);
+    event_deregister_observer(&component_cache->component_added_event, added_observer);
+    event_deregister_observer(&component_cache->component_removed_event, removed_observer);
 }
 
 void component_cache_send(const struct ComponentCache* component_cache, enum ECSEventType event_type, const EntityHandle entity_handle, const ComponentHandle component_handle)
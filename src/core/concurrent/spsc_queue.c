@@ -0,0 +1,100 @@
+#include "scieppend/core/concurrent/spsc_queue.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// INTERNAL FUNCS
+
+static int _round_up_pow2(int value)
+{
+    int pow2 = 1;
+    while(pow2 < value)
+    {
+        pow2 <<= 1;
+    }
+
+    return pow2;
+}
+
+// EXTERNAL FUNCS
+
+struct SPSCQueue* spsc_queue_new(int item_size, int capacity)
+{
+    struct SPSCQueue* queue = malloc(sizeof(struct SPSCQueue));
+    spsc_queue_init(queue, item_size, capacity);
+    return queue;
+}
+
+void spsc_queue_free(struct SPSCQueue* queue)
+{
+    spsc_queue_uninit(queue);
+    free(queue);
+}
+
+void spsc_queue_init(struct SPSCQueue* queue, int item_size, int capacity)
+{
+    capacity = _round_up_pow2(capacity);
+
+    queue->buffer = malloc(item_size * capacity);
+    if(!queue->buffer)
+    {
+        abort();
+    }
+
+    queue->item_size = item_size;
+    queue->mask = capacity - 1;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+}
+
+void spsc_queue_uninit(struct SPSCQueue* queue)
+{
+    free(queue->buffer);
+    queue->buffer = NULL;
+}
+
+int spsc_queue_capacity(const struct SPSCQueue* queue)
+{
+    return queue->mask + 1;
+}
+
+int spsc_queue_count(const struct SPSCQueue* queue)
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    return head - tail;
+#pragma GCC diagnostic pop
+}
+
+bool spsc_queue_push(struct SPSCQueue* queue, const void* item)
+{
+    // Indices only ever increase and wrap as unsigned, the slot is the index masked to the capacity
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+    if(head - tail > (unsigned int)queue->mask)
+    {
+        return false;
+    }
+
+    memcpy(queue->buffer + (head & queue->mask) * queue->item_size, item, queue->item_size);
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
+
+bool spsc_queue_pop(struct SPSCQueue* queue, void* out_item)
+{
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+    if(head == tail)
+    {
+        return false;
+    }
+
+    memcpy(out_item, queue->buffer + (tail & queue->mask) * queue->item_size, queue->item_size);
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
@@ -9,16 +9,20 @@
 
 typedef void(*resize_fp)(void);
 typedef void(*get_extents_fp)(int* w, int* h);
+typedef void(*refresh_fp)(void);
+typedef void(*uninit_fp)(void);
 
 struct DrawState
 {
-    bool resize;
+    volatile sig_atomic_t resize; // Set by SIGWINCH, the resize itself happens in draw_begin()
 };
 
 struct DrawFuncs
 {
     resize_fp      resize;
     get_extents_fp get_extents;
+    refresh_fp     refresh;
+    uninit_fp      uninit;
 };
 
 static struct DrawState state;
@@ -27,15 +31,14 @@ static struct DrawFuncs funcs;
 static void _sigwinch_handler([[maybe_unused]] int _)
 {
     state.resize = true;
+}
 
-    int w = 0;
-    int h = 0;
-    funcs.resize();
-    funcs.get_extents(&w, &h);
-    screen_set_extents(w, h);
-    state.resize = false;
-
-    log_format_msg(LOG_DEBUG, "Resizing screen to %dx%d", w, h);
+static void _set_term_funcs(void)
+{
+    funcs.resize      = &term_resize;
+    funcs.get_extents = &term_get_wh;
+    funcs.refresh     = &term_refresh;
+    funcs.uninit      = &term_uninit;
 }
 
 void draw_init(void)
@@ -44,18 +47,45 @@ void draw_init(void)
 
     //TODO: Eventually handle different drawing, like SDL
     term_init();
-    funcs.resize      = &term_resize;
-    funcs.get_extents = &term_get_wh;
+    _set_term_funcs();
 
     signal(SIGWINCH, &_sigwinch_handler);
 }
 
+void draw_init_headless(int width, int height, const char* path)
+{
+    state.resize = false;
+
+    term_init_headless(width, height, path);
+    _set_term_funcs();
+    screen_set_extents(width, height);
+}
+
 void draw_uninit(void)
 {
-    //TODO: Eventually handle different drawing, like SDL
-    term_uninit();
+    funcs.uninit();
 }
 
 void draw_begin(void)
 {
+    if(!state.resize)
+    {
+        return;
+    }
+
+    // Cleared first so a resize during this one is picked up next frame
+    state.resize = false;
+
+    int w = 0;
+    int h = 0;
+    funcs.resize();
+    funcs.get_extents(&w, &h);
+    screen_set_extents(w, h);
+
+    log_format_msg(LOG_DEBUG, "Resizing screen to %dx%d", w, h);
+}
+
+void draw_end(void)
+{
+    funcs.refresh();
 }
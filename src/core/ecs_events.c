@@ -1,5 +1,6 @@
 #include "scieppend/core/ecs_events.h"
 
+#include "scieppend/core/ecs_recorder.h"
 #include "scieppend/core/event.h"
 
 enum ECSEventType component_event_get_event_type(struct ComponentEventArgs* args)
@@ -18,7 +19,8 @@ void ecs_event_send_entity_event(const struct Event* event, enum ECSEventType ev
     event_args.base.event_type = event_type;
     event_args.entity_handle = entity_handle;
 
-    event_send(event, &event_args);
+    ecs_recorder_record_entity_event(event_type, entity_handle);
+    EVENT_CHANNEL_SEND(EntityEvent)(event, &event_args);
 }
 
 void ecs_event_send_component_event(const struct Event* event, enum ECSEventType event_type, EntityHandle entity_handle, ComponentTypeHandle component_type_handle, ComponentHandle component_handle)
@@ -29,5 +31,6 @@ void ecs_event_send_component_event(const struct Event* event, enum ECSEventType
     event_args.component_type = component_type_handle;
     event_args.component_handle = component_handle;
 
-    event_send(event, &event_args);
+    ecs_recorder_record_component_event(event_type, entity_handle, component_type_handle, component_handle);
+    EVENT_CHANNEL_SEND(ComponentEvent)(event, &event_args);
 }
@@ -0,0 +1,280 @@
+#include "scieppend/core/ecs_recorder.h"
+
+#include "scieppend/core/cache_map.h"
+#include "scieppend/core/ecs_world.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+
+#define C_RECORD_BYTES 16
+#define C_RECORD_BUFFER_RECORDS 4096
+
+static const char     C_RECORDING_MAGIC[4] = { 'S', 'E', 'C', 'R' };
+static const uint32_t C_RECORDING_VERSION  = 1;
+
+enum _RecordOp
+{
+    RECORD_OP_ENTITY_CREATED,
+    RECORD_OP_ENTITY_DESTROYED,
+    RECORD_OP_COMPONENT_ADDED,
+    RECORD_OP_COMPONENT_REMOVED,
+    RECORD_OP_UPDATE_SYSTEMS
+};
+
+/* One recorded operation.
+ * Written as 4 little endian 32-bit values: op, entity, component type, component handle.
+ */
+struct _Record
+{
+    uint32_t op;
+    int32_t  entity_handle;
+    int32_t  component_type_handle;
+    int32_t  component_handle;
+};
+
+static struct _Recorder
+{
+    atomic_bool   recording;
+    mtx_t         lock;
+    FILE*         file;
+    int           buffered;
+    unsigned char buffer[C_RECORD_BUFFER_RECORDS * C_RECORD_BYTES];
+} _recorder;
+
+static once_flag _recorder_once = ONCE_FLAG_INIT;
+
+// INTERNAL FUNCS
+
+static void _recorder_init_lock(void)
+{
+    mtx_init(&_recorder.lock, mtx_plain);
+}
+
+static void _write_u32(unsigned char* dst, uint32_t value)
+{
+    dst[0] = (unsigned char)(value);
+    dst[1] = (unsigned char)(value >> 8);
+    dst[2] = (unsigned char)(value >> 16);
+    dst[3] = (unsigned char)(value >> 24);
+}
+
+static uint32_t _read_u32(const unsigned char* src)
+{
+    return (uint32_t)src[0] |
+           ((uint32_t)src[1] << 8) |
+           ((uint32_t)src[2] << 16) |
+           ((uint32_t)src[3] << 24);
+}
+
+// Write out the buffered records. Must be called with the lock held.
+static void _flush(void)
+{
+    if(_recorder.buffered > 0)
+    {
+        fwrite(_recorder.buffer, C_RECORD_BYTES, _recorder.buffered, _recorder.file);
+        _recorder.buffered = 0;
+    }
+}
+
+static void _record(const struct _Record* record)
+{
+    if(!atomic_load_explicit(&_recorder.recording, memory_order_relaxed))
+    {
+        return;
+    }
+
+    mtx_lock(&_recorder.lock);
+
+    // Recording may have stopped while waiting for the lock
+    if(_recorder.file)
+    {
+        if(_recorder.buffered == C_RECORD_BUFFER_RECORDS)
+        {
+            _flush();
+        }
+
+        unsigned char* dst = &_recorder.buffer[_recorder.buffered * C_RECORD_BYTES];
+        _write_u32(dst, record->op);
+        _write_u32(dst + 4, (uint32_t)record->entity_handle);
+        _write_u32(dst + 8, (uint32_t)record->component_type_handle);
+        _write_u32(dst + 12, (uint32_t)record->component_handle);
+        ++_recorder.buffered;
+    }
+
+    mtx_unlock(&_recorder.lock);
+}
+
+static bool _read_record(FILE* file, struct _Record* record)
+{
+    unsigned char src[C_RECORD_BYTES];
+    if(fread(src, C_RECORD_BYTES, 1, file) != 1)
+    {
+        return false;
+    }
+
+    record->op = _read_u32(src);
+    record->entity_handle = (int32_t)_read_u32(src + 4);
+    record->component_type_handle = (int32_t)_read_u32(src + 8);
+    record->component_handle = (int32_t)_read_u32(src + 12);
+    return true;
+}
+
+// Look up the world's handle for a recorded entity handle
+static EntityHandle _map_entity(const struct CacheMap* entity_map, EntityHandle recorded_handle)
+{
+    const EntityHandle* handle = cache_map_get_hashed(entity_map, recorded_handle);
+    return handle ? *handle : C_NULL_ENTITY_HANDLE;
+}
+
+// EXTERNAL FUNCS
+
+bool ecs_recorder_start(const char* path)
+{
+    call_once(&_recorder_once, &_recorder_init_lock);
+
+    mtx_lock(&_recorder.lock);
+
+    if(_recorder.file)
+    {
+        mtx_unlock(&_recorder.lock);
+        return false;
+    }
+
+    _recorder.file = fopen(path, "wb");
+    if(!_recorder.file)
+    {
+        mtx_unlock(&_recorder.lock);
+        return false;
+    }
+
+    unsigned char header[8];
+    memcpy(header, C_RECORDING_MAGIC, sizeof(C_RECORDING_MAGIC));
+    _write_u32(header + 4, C_RECORDING_VERSION);
+    fwrite(header, sizeof(header), 1, _recorder.file);
+
+    _recorder.buffered = 0;
+    atomic_store(&_recorder.recording, true);
+
+    mtx_unlock(&_recorder.lock);
+    return true;
+}
+
+void ecs_recorder_stop(void)
+{
+    call_once(&_recorder_once, &_recorder_init_lock);
+
+    mtx_lock(&_recorder.lock);
+
+    atomic_store(&_recorder.recording, false);
+
+    if(_recorder.file)
+    {
+        _flush();
+        fclose(_recorder.file);
+        _recorder.file = NULL;
+    }
+
+    mtx_unlock(&_recorder.lock);
+}
+
+bool ecs_recorder_is_recording(void)
+{
+    return atomic_load(&_recorder.recording);
+}
+
+void ecs_recorder_record_entity_event(enum ECSEventType event_type, EntityHandle entity_handle)
+{
+    struct _Record record;
+    record.op = event_type == EVENT_ENTITY_CREATED ? RECORD_OP_ENTITY_CREATED : RECORD_OP_ENTITY_DESTROYED;
+    record.entity_handle = entity_handle;
+    record.component_type_handle = C_NULL_COMPONENT_TYPE;
+    record.component_handle = C_NULL_COMPONENT_HANDLE;
+    _record(&record);
+}
+
+void ecs_recorder_record_component_event(enum ECSEventType event_type, EntityHandle entity_handle, ComponentTypeHandle component_type_handle, ComponentHandle component_handle)
+{
+    struct _Record record;
+    record.op = event_type == EVENT_COMPONENT_ADDED ? RECORD_OP_COMPONENT_ADDED : RECORD_OP_COMPONENT_REMOVED;
+    record.entity_handle = entity_handle;
+    record.component_type_handle = component_type_handle;
+    record.component_handle = component_handle;
+    _record(&record);
+}
+
+void ecs_recorder_record_update_systems(void)
+{
+    struct _Record record;
+    record.op = RECORD_OP_UPDATE_SYSTEMS;
+    record.entity_handle = C_NULL_ENTITY_HANDLE;
+    record.component_type_handle = C_NULL_COMPONENT_TYPE;
+    record.component_handle = C_NULL_COMPONENT_HANDLE;
+    _record(&record);
+}
+
+int ecs_replay(struct ECSWorld* world, const char* path)
+{
+    if(ecs_recorder_is_recording())
+    {
+        return -1;
+    }
+
+    FILE* file = fopen(path, "rb");
+    if(!file)
+    {
+        return -1;
+    }
+
+    unsigned char header[8];
+    if(fread(header, sizeof(header), 1, file) != 1 ||
+       memcmp(header, C_RECORDING_MAGIC, sizeof(C_RECORDING_MAGIC)) != 0 ||
+       _read_u32(header + 4) != C_RECORDING_VERSION)
+    {
+        fclose(file);
+        return -1;
+    }
+
+    // Recorded entity handle -> entity handle in this world
+    struct CacheMap entity_map;
+    cache_map_init(&entity_map, sizeof(EntityHandle), 1024, NULL, NULL);
+
+    int replayed = 0;
+    struct _Record record;
+    while(_read_record(file, &record))
+    {
+        switch(record.op)
+        {
+            case RECORD_OP_ENTITY_CREATED:
+                {
+                    EntityHandle entity_handle = ecs_world_create_entity(world);
+                    cache_map_add(&entity_map, &record.entity_handle, sizeof(int), &entity_handle);
+                }
+                break;
+            case RECORD_OP_ENTITY_DESTROYED:
+                ecs_world_destroy_entity(world, _map_entity(&entity_map, record.entity_handle));
+                cache_map_remove(&entity_map, &record.entity_handle, sizeof(int));
+                break;
+            case RECORD_OP_COMPONENT_ADDED:
+                ecs_world_entity_add_component(world, _map_entity(&entity_map, record.entity_handle), record.component_type_handle);
+                break;
+            case RECORD_OP_COMPONENT_REMOVED:
+                ecs_world_entity_remove_component(world, _map_entity(&entity_map, record.entity_handle), record.component_type_handle);
+                break;
+            case RECORD_OP_UPDATE_SYSTEMS:
+                ecs_world_update_systems(world);
+                break;
+            default:
+                break;
+        }
+
+        ++replayed;
+    }
+
+    cache_map_uninit(&entity_map);
+    fclose(file);
+
+    return replayed;
+}
@@ -1,11 +1,12 @@
 #include "scieppend/core/ecs_world.h"
 
 #include "scieppend/core/array.h"
-#include "scieppend/core/cache_map.h"
+#include "scieppend/core/cache_map_threadsafe.h"
 #include "scieppend/core/cache_threadsafe.h"
 #include "scieppend/core/component.h"
 #include "scieppend/core/component_cache.h"
 #include "scieppend/core/ecs_events.h"
+#include "scieppend/core/ecs_recorder.h"
 #include "scieppend/core/entity.h"
 #include "scieppend/core/string.h"
 #include "scieppend/core/system.h"
@@ -19,9 +20,9 @@ const int C_NULL_COMPONENT_HANDLE = 0xffffffff;
 
 struct ECSWorld
 {
-    struct Cache_ThreadSafe entities;         // Cache_ThreadSafe<_Entity>
-    struct CacheMap         systems;          // CacheMap<System>
-    struct CacheMap         component_caches; // CacheMap<ComponentCache>
+    struct Cache_ThreadSafe    entities;         // Cache_ThreadSafe<_Entity>
+    struct CacheMap_ThreadSafe systems;          // CacheMap_ThreadSafe<System>, keyed by interned name id
+    struct CacheMap_ThreadSafe component_caches; // CacheMap_ThreadSafe<ComponentCache>
 
     struct Event entity_created_event;
     struct Event entity_destroyed_event;
@@ -32,9 +33,9 @@ struct ECSWorld
 struct ECSWorld* ecs_world_new(void)
 {
     struct ECSWorld* new_ecs_world = malloc(sizeof(struct ECSWorld));
-    cache_map_init(&new_ecs_world->component_caches, sizeof(struct ComponentCache), 32, &component_cache_init_wrapper, &component_cache_uninit_wrapper);
-    cache_map_init(&new_ecs_world->systems, sizeof(struct System), 32, &system_init_wrapper, &system_uninit_wrapper);
-    cache_ts_init(&new_ecs_world->entities, sizeof(struct Entity), 1024, &entity_init_wrapper, &entity_uninit_wrapper);
+    cache_map_ts_init(&new_ecs_world->component_caches, sizeof(struct ComponentCache), 32, &component_cache_init_wrapper, &component_cache_uninit_wrapper);
+    cache_map_ts_init(&new_ecs_world->systems, sizeof(struct System), 32, &system_init_wrapper, &system_uninit_wrapper);
+    cache_ts_init_paged(&new_ecs_world->entities, sizeof(struct Entity), 1024, &entity_init_wrapper, &entity_uninit_wrapper);
 
     event_init(&new_ecs_world->entity_created_event);
     event_init(&new_ecs_world->entity_destroyed_event);
@@ -48,8 +49,8 @@ void ecs_world_free(struct ECSWorld* world)
     event_uninit(&world->entity_created_event);
 
     cache_ts_uninit(&world->entities);
-    cache_map_uninit(&world->systems);
-    cache_map_uninit(&world->component_caches);
+    cache_map_ts_uninit(&world->systems);
+    cache_map_ts_uninit(&world->component_caches);
 
     free(world);
 }
@@ -61,23 +62,28 @@ int ecs_world_entities_count(const struct ECSWorld* world)
 
 int ecs_world_systems_count(const struct ECSWorld* world)
 {
-    return cache_map_count(&world->systems);
+    return cache_map_ts_count(&world->systems);
 }
 
 int ecs_world_component_types_count(const struct ECSWorld* world)
 {
-    return cache_map_count(&world->component_caches);
+    return cache_map_ts_count(&world->component_caches);
 }
 
 int ecs_world_components_count(const struct ECSWorld* world, ComponentTypeHandle component_type_handle)
 {
-    struct ComponentCache* component_cache = cache_map_get_hashed(&world->component_caches, component_type_handle);
+    struct ComponentCache* component_cache = cache_map_ts_get_hashed(&world->component_caches, component_type_handle);
     return component_cache_count(component_cache);
 }
 
 EntityHandle ecs_world_create_entity(struct ECSWorld* world)
 {
-    return cache_ts_emplace(&world->entities, world);
+    EntityHandle entity_handle = cache_ts_emplace(&world->entities, world);
+
+    // Creation does not send an event, so it is recorded here
+    ecs_recorder_record_entity_event(EVENT_ENTITY_CREATED, entity_handle);
+
+    return entity_handle;
 }
 
 void ecs_world_destroy_entity(struct ECSWorld* world, EntityHandle entity_handle)
@@ -94,7 +100,7 @@ void ecs_world_destroy_entity(struct ECSWorld* world, EntityHandle entity_handle
         for(int i = 0; i < array_count(components); ++i)
         {
             struct ComponentLookup* lookup = array_get(components, i);
-            struct ComponentCache* component_cache = cache_map_get_hashed(&world->component_caches, lookup->component_type_handle);
+            struct ComponentCache* component_cache = cache_map_ts_get_hashed(&world->component_caches, lookup->component_type_handle);
             component_cache_remove_component(component_cache, lookup->component_handle);
         }
 
@@ -119,7 +125,7 @@ void ecs_world_entity_add_component(struct ECSWorld* world, const EntityHandle e
     {
         if (!entity_has_component(entity, component_type_handle))
         {
-            component_cache = cache_map_get_hashed(&world->component_caches, component_type_handle);
+            component_cache = cache_map_ts_get_hashed(&world->component_caches, component_type_handle);
             component_handle = component_cache_emplace_component(component_cache, NULL);
             entity_add_component(entity, component_handle, component_type_handle);
         }
@@ -147,7 +153,7 @@ void ecs_world_entity_remove_component(struct ECSWorld* world, const EntityHandl
         if(component_handle != C_NULL_COMPONENT_HANDLE)
         {
             entity_remove_component(entity, component_type_handle);
-            component_cache = cache_map_get_hashed(&world->component_caches, component_type_handle);
+            component_cache = cache_map_ts_get_hashed(&world->component_caches, component_type_handle);
             component_cache_remove_component(component_cache, component_handle);
         }
     }
@@ -230,7 +236,7 @@ bool ecs_world_entity_has_components(struct ECSWorld* world, EntityHandle entity
 
 void* ecs_world_entity_get_component(struct ECSWorld* world, const EntityHandle entity_handle, const ComponentTypeHandle component_type_handle, bool write)
 {
-    struct ComponentCache* component_cache = cache_map_get_hashed(&world->component_caches, component_type_handle);
+    struct ComponentCache* component_cache = cache_map_ts_get_hashed(&world->component_caches, component_type_handle);
     if (!component_cache)
     {
         return NULL;
@@ -258,7 +264,7 @@ void* ecs_world_entity_get_component(struct ECSWorld* world, const EntityHandle
 
 void ecs_world_entity_unget_component(struct ECSWorld* world, const EntityHandle entity_handle, const ComponentTypeHandle component_type_handle, bool write)
 {
-    struct ComponentCache* component_cache = cache_map_get_hashed(&world->component_caches, component_type_handle);
+    struct ComponentCache* component_cache = cache_map_ts_get_hashed(&world->component_caches, component_type_handle);
     if (!component_cache)
     {
         return;
@@ -289,7 +295,7 @@ void* ecs_world_get_component(struct ECSWorld* world, const ComponentHandle comp
 
     if(component_handle != C_NULL_COMPONENT_HANDLE)
     {
-        struct ComponentCache* component_cache = cache_map_get_hashed(&world->component_caches, component_type_handle);
+        struct ComponentCache* component_cache = cache_map_ts_get_hashed(&world->component_caches, component_type_handle);
         if (component_cache != NULL)
         {
             component = component_cache_get_component(component_cache, component_handle, write);
@@ -303,7 +309,7 @@ void ecs_world_unget_component(struct ECSWorld* world, const ComponentHandle com
 {
     if(component_handle != C_NULL_COMPONENT_HANDLE)
     {
-        struct ComponentCache* component_cache = cache_map_get_hashed(&world->component_caches, component_type_handle);
+        struct ComponentCache* component_cache = cache_map_ts_get_hashed(&world->component_caches, component_type_handle);
         if(component_cache != NULL)
         {
             component_cache_unget_component(component_cache, component_handle, write);
@@ -315,9 +321,12 @@ void ecs_world_unget_component(struct ECSWorld* world, const ComponentHandle com
 
 void ecs_world_component_type_register(struct ECSWorld* world, const ComponentTypeHandle component_type_handle, int bytes)
 {
-    if(cache_map_get_hashed(&world->component_caches, component_type_handle))
+    cache_map_ts_lock(&world->component_caches, WRITE);
+
+    if(cache_map_get_hashed(&world->component_caches.map, component_type_handle))
     {
         // TODO: Log warning
+        cache_map_ts_unlock(&world->component_caches, WRITE);
         return;
     }
 
@@ -328,42 +337,49 @@ void ecs_world_component_type_register(struct ECSWorld* world, const ComponentTy
     args.alloc_func = NULL;
     args.free_func = NULL;
 
-    cache_map_emplace_hashed(&world->component_caches, component_type_handle, &args);
+    cache_map_emplace_hashed(&world->component_caches.map, component_type_handle, &args);
+
+    cache_map_ts_unlock(&world->component_caches, WRITE);
 }
 
 void ecs_world_component_type_lock(struct ECSWorld* world, const ComponentTypeHandle component_type_handle, bool write)
 {
-    struct ComponentCache* component_cache = cache_map_get_hashed(&world->component_caches, component_type_handle);
+    struct ComponentCache* component_cache = cache_map_ts_get_hashed(&world->component_caches, component_type_handle);
     component_cache_lock(component_cache, write);
 }
 
 void ecs_world_component_type_unlock(struct ECSWorld* world, const ComponentTypeHandle component_type_handle, bool write)
 {
-    struct ComponentCache* component_cache = cache_map_get_hashed(&world->component_caches, component_type_handle);
+    struct ComponentCache* component_cache = cache_map_ts_get_hashed(&world->component_caches, component_type_handle);
     component_cache_unlock(component_cache, write);
 }
 
-void ecs_world_component_type_register_observer(struct ECSWorld* world, const ComponentTypeHandle component_type_handle, const ObserverHandle observer)
+void ecs_world_component_type_register_observers(struct ECSWorld* world, const ComponentTypeHandle component_type_handle, const ObserverHandle added_observer, const ObserverHandle removed_observer)
 {
-    struct ComponentCache* component_cache = cache_map_get_hashed(&world->component_caches, component_type_handle);
-    component_cache_register_observer(component_cache, observer);
+    struct ComponentCache* component_cache = cache_map_ts_get_hashed(&world->component_caches, component_type_handle);
+    component_cache_register_observers(component_cache, added_observer, removed_observer);
 }
 
-void ecs_world_component_type_deregister_observer(struct ECSWorld* world, const ComponentTypeHandle component_type_handle, const ObserverHandle observer)
+void ecs_world_component_type_deregister_observers(struct ECSWorld* world, const ComponentTypeHandle component_type_handle, const ObserverHandle added_observer, const ObserverHandle removed_observer)
 {
-    struct ComponentCache* component_cache = cache_map_get_hashed(&world->component_caches, component_type_handle);
-    component_cache_deregister_observer(component_cache, observer);
+    struct ComponentCache* component_cache = cache_map_ts_get_hashed(&world->component_caches, component_type_handle);
+    component_cache_deregister_observers(component_cache, added_observer, removed_observer);
 }
 
 bool ecs_world_component_type_is_registered(struct ECSWorld* world, const ComponentTypeHandle component_type_handle)
 {
-    return cache_map_get_hashed(&world->component_caches, component_type_handle) != NULL;
+    return cache_map_ts_get_hashed(&world->component_caches, component_type_handle) != NULL;
 }
 
 void ecs_world_system_register(struct ECSWorld* world, const struct string* system_name, const struct Array* required_components, SystemUpdateFn update_func)
 {
-    if(cache_map_get(&world->systems, system_name->buffer, system_name->size))
+    int name_id = string_intern(system_name);
+
+    cache_map_ts_lock(&world->systems, WRITE);
+
+    if(cache_map_get_hashed(&world->systems.map, name_id))
     {
+        cache_map_ts_unlock(&world->systems, WRITE);
         return;
     }
 
@@ -379,46 +395,80 @@ void ecs_world_system_register(struct ECSWorld* world, const struct string* syst
     args.required_components = required_components;
     args.update_func = update_func;
 
-    struct System* system = cache_map_emplace(&world->systems, system_name->buffer, system_name->size, &args);
+    struct System* system = cache_map_emplace_hashed(&world->systems.map, name_id, &args);
+
+    cache_map_ts_unlock(&world->systems, WRITE);
 
-    event_register_observer(&world->entity_created_event, system->observer_handle);
-    event_register_observer(&world->entity_destroyed_event, system->observer_handle);
+    event_register_observer(&world->entity_created_event, system->entity_created_observer);
+    event_register_observer(&world->entity_destroyed_event, system->entity_destroyed_observer);
 }
 
 struct System* ecs_world_get_system(const struct ECSWorld* world, const struct string* system_name)
 {
-    return cache_map_get(&world->systems, system_name->buffer, system_name->size);
+    // A name that was never interned cannot belong to a registered system
+    int name_id = string_intern_find(system_name);
+    if(name_id == C_NULL_STRING_ID)
+    {
+        return NULL;
+    }
+
+    return ecs_world_get_system_by_id(world, name_id);
+}
+
+struct System* ecs_world_get_system_by_id(const struct ECSWorld* world, int system_name_id)
+{
+    return cache_map_ts_get_hashed(&world->systems, system_name_id);
 }
 
 void ecs_world_update_systems(const struct ECSWorld* world)
 {
-    struct It it = cache_map_begin(&world->systems);
-    struct It end = cache_map_end(&world->systems);
+    ecs_recorder_record_update_systems();
+
+    // Take a snapshot of the systems so the lock isn't held while they update. Systems can look up
+    // other systems, and a nested read would deadlock against a waiting writer.
+    struct Array systems;
+
+    cache_map_ts_lock(&world->systems, READ);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
+    array_init(&systems, sizeof(struct System*), cache_map_count(&world->systems.map), NULL, NULL);
 
+    struct It it = cache_map_begin(&world->systems.map);
+    struct It end = cache_map_end(&world->systems.map);
     for(; !it_eq(&it, &end); cache_map_it_next(&it))
     {
         struct System* system = cache_map_it_get(&it);
+        array_add(&systems, &system);
+    }
+#pragma GCC diagnostic pop
+
+    cache_map_ts_unlock(&world->systems, READ);
+
+    for(int i = 0; i < array_count(&systems); ++i)
+    {
+        struct System* system = *(struct System**)array_get(&systems, i);
         system_process_ecs_commands(system);
     }
 
-    it = cache_map_begin(&world->systems);
-    for(; !it_eq(&it, &end); cache_map_it_next(&it))
+    for(int i = 0; i < array_count(&systems); ++i)
     {
-        struct System* system = cache_map_it_get(&it);
+        struct System* system = *(struct System**)array_get(&systems, i);
         system_update(system);
     }
 
-    it = cache_map_begin(&world->systems);
-    for(; !it_eq(&it, &end); cache_map_it_next(&it))
+    for(int i = 0; i < array_count(&systems); ++i)
     {
-        struct System* system = cache_map_it_get(&it);
+        struct System* system = *(struct System**)array_get(&systems, i);
         system_process_ecs_commands(system);
     }
+
+    array_uninit(&systems);
 }
 
 int ecs_world_system_entities_count(const struct ECSWorld* world, const struct string* system_name)
 {
-    const struct System* system = cache_map_get(&world->systems, system_name->buffer,  system_name->size);
+    const struct System* system = ecs_world_get_system(world, system_name);
 
     return system_entities_count(system);
 }
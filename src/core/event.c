@@ -3,8 +3,10 @@
 #include "scieppend/core/cache_threadsafe.h"
 #include "scieppend/core/container_common.h"
 
+#include <assert.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 static struct _ObserverManager
 {
@@ -13,8 +15,17 @@ static struct _ObserverManager
 
 struct Observer
 {
-    void*             observer_data;
-    event_callback_fn callback_func;
+    void*                   observer_data;
+    event_callback_fn       callback_func;
+    event_batch_callback_fn batch_callback_func;
+};
+
+// Immutable copy of an event's observers, published for senders to read without locking
+struct ObserverList
+{
+    struct ObserverList* next_retired;
+    int                  count;
+    struct Observer      observers[];
 };
 
 // INTERNAL FUNCS
@@ -24,13 +35,164 @@ static int _compare_observer_handle(const void* lhs, const void* rhs)
     return *(const ObserverHandle*)lhs == *(const ObserverHandle*)rhs;
 }
 
+/* Build a new observer list from the event's observer handles and publish it.
+ * Must be called with the event's observers array write locked. The replaced list is retired rather
+ * than freed, as senders may still be iterating it.
+ */
+static void _publish_observer_list(struct Event* event)
+{
+    int count = array_count(&event->observers.array);
+
+    struct ObserverList* list = malloc(sizeof(struct ObserverList) + (count * sizeof(struct Observer)));
+    if(!list)
+    {
+        abort();
+    }
+
+    list->next_retired = NULL;
+    list->count = 0;
+
+    cache_ts_lock(&_obs_man.observers, READ);
+    for(int i = 0; i < count; ++i)
+    {
+        const ObserverHandle* obs_h = array_get(&event->observers.array, i);
+        const struct Observer* obs = cache_get(&_obs_man.observers.cache, *obs_h);
+
+        // Destroyed without being deregistered, so its data may be gone
+        if(!obs)
+        {
+            continue;
+        }
+
+        list->observers[list->count++] = *obs;
+    }
+    cache_ts_unlock(&_obs_man.observers, READ);
+
+    struct ObserverList* old_list = atomic_exchange_explicit(&event->observer_list, list, memory_order_acq_rel);
+    old_list->next_retired = event->retired_lists;
+    event->retired_lists = old_list;
+}
+
+static inline const struct ObserverList* _get_observer_list(const struct Event* event)
+{
+    return atomic_load_explicit(&event->observer_list, memory_order_acquire);
+}
+
+static void _queue_init(struct EventQueue* queue, int args_size, int capacity)
+{
+    mtx_init(&queue->lock, mtx_plain);
+    queue->args_size = args_size;
+    queue->capacity = capacity > 0 ? capacity : 1;
+    queue->head = 0;
+    queue->count = 0;
+    queue->buffer = malloc(queue->capacity * args_size);
+    queue->batch = NULL;
+    queue->batch_capacity = 0;
+
+    if(!queue->buffer)
+    {
+        abort();
+    }
+}
+
+static void _queue_uninit(struct EventQueue* queue)
+{
+    free(queue->batch);
+    free(queue->buffer);
+    mtx_destroy(&queue->lock);
+}
+
+// Copy count args starting at the head of the ring into dst, unwrapping them
+static void _queue_copy_out(const struct EventQueue* queue, char* dst)
+{
+    int first_count = queue->capacity - queue->head;
+    if(first_count > queue->count)
+    {
+        first_count = queue->count;
+    }
+
+    memcpy(dst, queue->buffer + (queue->head * queue->args_size), first_count * queue->args_size);
+    memcpy(dst + (first_count * queue->args_size), queue->buffer, (queue->count - first_count) * queue->args_size);
+}
+
+// Double the ring's capacity, moving the queued args to the start of the new buffer
+static void _queue_grow(struct EventQueue* queue)
+{
+    int new_capacity = queue->capacity * 2;
+    char* new_buffer = malloc(new_capacity * queue->args_size);
+    if(!new_buffer)
+    {
+        abort();
+    }
+
+    _queue_copy_out(queue, new_buffer);
+    free(queue->buffer);
+
+    queue->buffer = new_buffer;
+    queue->capacity = new_capacity;
+    queue->head = 0;
+}
+
+static void _queue_push(struct EventQueue* queue, const void* event_args)
+{
+    mtx_lock(&queue->lock);
+
+    if(queue->count == queue->capacity)
+    {
+        _queue_grow(queue);
+    }
+
+    int tail = (queue->head + queue->count) % queue->capacity;
+    memcpy(queue->buffer + (tail * queue->args_size), event_args, queue->args_size);
+    ++queue->count;
+
+    mtx_unlock(&queue->lock);
+}
+
+// Move everything queued into the batch buffer and return how many args were taken
+static int _queue_take_batch(struct EventQueue* queue)
+{
+    mtx_lock(&queue->lock);
+
+    int count = queue->count;
+    if(count > queue->batch_capacity)
+    {
+        free(queue->batch);
+        queue->batch = malloc(count * queue->args_size);
+        queue->batch_capacity = count;
+
+        if(!queue->batch)
+        {
+            abort();
+        }
+    }
+
+    if(count > 0)
+    {
+        _queue_copy_out(queue, queue->batch);
+    }
+
+    queue->head = 0;
+    queue->count = 0;
+
+    mtx_unlock(&queue->lock);
+
+    return count;
+}
+
 // EXTENRAL FUNCS
 
 ObserverHandle observer_create(void* observer_data, event_callback_fn event_callback_func)
+{
+    return observer_create_batched(observer_data, event_callback_func, NULL);
+}
+
+ObserverHandle observer_create_batched(void* observer_data, event_callback_fn callback_func, event_batch_callback_fn batch_callback_func)
 {
     struct Observer new_obs;
     new_obs.observer_data = observer_data;
-    new_obs.callback_func = event_callback_func;
+    new_obs.callback_func = callback_func;
+    new_obs.batch_callback_func = batch_callback_func;
     return cache_ts_add(&_obs_man.observers, &new_obs);
 }
 
@@ -55,39 +217,151 @@ void event_free(struct Event* event)
 void event_init(struct Event* event)
 {
     array_ts_init(&event->observers, sizeof(ObserverHandle), 8, NULL, NULL);
+
+    struct ObserverList* list = malloc(sizeof(struct ObserverList));
+    if(!list)
+    {
+        abort();
+    }
+
+    list->next_retired = NULL;
+    list->count = 0;
+    atomic_init(&event->observer_list, list);
+    event->retired_lists = NULL;
+    event->queue = NULL;
+}
+
+void event_init_queued(struct Event* event, int args_size, int capacity)
+{
+    event_init(event);
+    event->queue = malloc(sizeof(struct EventQueue));
+    if(!event->queue)
+    {
+        abort();
+    }
+
+    _queue_init(event->queue, args_size, capacity);
 }
 
 void event_uninit(struct Event* event)
 {
+    if(event->queue)
+    {
+        _queue_uninit(event->queue);
+        free(event->queue);
+        event->queue = NULL;
+    }
+
+    while(event->retired_lists)
+    {
+        struct ObserverList* next = event->retired_lists->next_retired;
+        free(event->retired_lists);
+        event->retired_lists = next;
+    }
+
+    free(atomic_load(&event->observer_list));
     array_ts_uninit(&event->observers);
 }
 
 int event_observer_count(const struct Event* event)
 {
-    return array_ts_count(&event->observers);
+    return _get_observer_list(event)->count;
+}
+
+int event_queued_count(const struct Event* event)
+{
+    if(!event->queue)
+    {
+        return 0;
+    }
+
+    mtx_lock(&event->queue->lock);
+    int count = event->queue->count;
+    mtx_unlock(&event->queue->lock);
+
+    return count;
 }
 
 void event_register_observer(struct Event* event, ObserverHandle obs_handle)
 {
-    array_ts_add(&event->observers, &obs_handle);
+    assert(cache_ts_get(&_obs_man.observers, obs_handle) && "Observer has been destroyed");
+
+    array_ts_lock(&event->observers, WRITE);
+    array_add(&event->observers.array, &obs_handle);
+    _publish_observer_list(event);
+    array_ts_unlock(&event->observers, WRITE);
 }
 
 void event_deregister_observer(struct Event* event, ObserverHandle obs_handle)
 {
-    int idx = array_ts_find(&event->observers, &obs_handle, &_compare_observer_handle);
+    array_ts_lock(&event->observers, WRITE);
+
+    int idx = array_find(&event->observers.array, &obs_handle, &_compare_observer_handle);
     if(idx != -1)
     {
-        array_ts_remove_at(&event->observers, idx);
+        array_remove_at(&event->observers.array, idx);
+        _publish_observer_list(event);
     }
+
+    array_ts_unlock(&event->observers, WRITE);
 }
 
 void event_send(const struct Event* event, void* event_args)
 {
-    for(int i = 0; i < array_ts_count(&event->observers); ++i)
+    if(event->queue)
     {
-        ObserverHandle* obs_h = array_ts_get(&event->observers, i);
-        struct Observer* obs = cache_ts_get(&_obs_man.observers, *obs_h);
-        obs->callback_func(event, obs->observer_data, event_args);
+        _queue_push(event->queue, event_args);
+        return;
+    }
+
+    const struct ObserverList* list = _get_observer_list(event);
+
+    for(int i = 0; i < list->count; ++i)
+    {
+        const struct Observer* obs = &list->observers[i];
+
+        if(obs->callback_func)
+        {
+            obs->callback_func(event, obs->observer_data, event_args);
+        }
+        else
+        {
+            // Batch only observers get each immediate event as a batch of one
+            obs->batch_callback_func(event, obs->observer_data, event_args, 1, 0);
+        }
+    }
+}
+
+void event_flush(const struct Event* event)
+{
+    struct EventQueue* queue = event->queue;
+    if(!queue)
+    {
+        return;
+    }
+
+    int count = _queue_take_batch(queue);
+    if(count == 0)
+    {
+        return;
+    }
+
+    const struct ObserverList* list = _get_observer_list(event);
+
+    for(int i = 0; i < list->count; ++i)
+    {
+        const struct Observer* obs = &list->observers[i];
+
+        if(obs->batch_callback_func)
+        {
+            obs->batch_callback_func(event, obs->observer_data, queue->batch, count, queue->args_size);
+            continue;
+        }
+
+        for(int args_idx = 0; args_idx < count; ++args_idx)
+        {
+            obs->callback_func(event, obs->observer_data, queue->batch + (args_idx * queue->args_size));
+        }
     }
 }
 
@@ -1,19 +1,108 @@
 #include "scieppend/core/hash.h"
 
-const long C_FNV_OFFSET_BASIS = 2166136261;
-const int  C_FNV_PRIME = 16777619;
+#include <stdint.h>
+#include <string.h>
 
-// Simple FNV-1 hash
-// See: https://en.wikipedia.org/wiki/Fowler-Noll-Vo_hash_function
-int hash(const char* buffer, const int size_bytes)
+#define C_HASH64_LANES 4
+#define C_HASH64_WORD_BYTES 8
+#define C_HASH64_STRIPE_BYTES (C_HASH64_LANES * C_HASH64_WORD_BYTES)
+
+static const uint64_t C_HASH64_SEED   = 0xa0761d6478bd642full;
+static const uint64_t C_HASH64_PRIME1 = 0xe7037ed1a0b428dbull;
+static const uint64_t C_HASH64_PRIME2 = 0x8ebc6af09c88c6e3ull;
+
+static const uint64_t C_HASH64_LANE_SECRETS[C_HASH64_LANES] =
+{
+    0xa0761d6478bd642full,
+    0xe7037ed1a0b428dbull,
+    0x8ebc6af09c88c6e3ull,
+    0x589965cc75374cc3ull
+};
+
+__extension__ typedef unsigned __int128 _uint128;
+
+// INTERNAL FUNCS
+
+// Multiply to 128 bits and fold the halves together
+static inline uint64_t _mum(uint64_t a, uint64_t b)
 {
-    long h = C_FNV_OFFSET_BASIS;
+    _uint128 r = (_uint128)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
 
+// Read 8 bytes as a little endian word
+static inline uint64_t _read64(const unsigned char* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+// Read the last 0 to 7 bytes as a zero padded little endian word
+static inline uint64_t _read_tail(const unsigned char* p, int size_bytes)
+{
+    uint64_t v = 0;
     for(int i = 0; i < size_bytes; ++i)
     {
-        h *= C_FNV_PRIME;
-        h ^= buffer[i];
+        v |= (uint64_t)p[i] << (i * 8);
     }
 
-    return h;
+    return v;
+}
+
+/* Hash whole 32 byte stripes with 4 independent lanes, one word per lane per stripe.
+ * The lanes have no dependency on each other, so their multiplies run in parallel.
+ */
+static uint64_t _hash_stripes(const unsigned char* p, int stripe_count, uint64_t h)
+{
+    uint64_t lanes[C_HASH64_LANES];
+    for(int lane = 0; lane < C_HASH64_LANES; ++lane)
+    {
+        lanes[lane] = h ^ C_HASH64_LANE_SECRETS[lane];
+    }
+
+    for(int stripe = 0; stripe < stripe_count; ++stripe, p += C_HASH64_STRIPE_BYTES)
+    {
+        for(int lane = 0; lane < C_HASH64_LANES; ++lane)
+        {
+            lanes[lane] = _mum(_read64(p + (lane * C_HASH64_WORD_BYTES)) ^ C_HASH64_LANE_SECRETS[lane], lanes[lane] ^ C_HASH64_PRIME2);
+        }
+    }
+
+    return _mum(lanes[0] ^ C_HASH64_PRIME1, lanes[1] ^ C_HASH64_PRIME2) ^
+           _mum(lanes[2] ^ C_HASH64_PRIME1, lanes[3] ^ C_HASH64_PRIME2);
+}
+
+// EXTERNAL FUNCS
+
+int hash(const char* buffer, const int size_bytes)
+{
+    uint64_t h = hash64(buffer, size_bytes);
+    return (int)(uint32_t)(h ^ (h >> 32));
+}
+
+unsigned long long hash64(const void* buffer, const int size_bytes)
+{
+    const unsigned char* p = buffer;
+    uint64_t h = C_HASH64_SEED ^ (uint64_t)size_bytes;
+
+    int i = 0;
+    int stripe_count = size_bytes / C_HASH64_STRIPE_BYTES;
+    if(stripe_count > 0)
+    {
+        h = _hash_stripes(p, stripe_count, h);
+        i = stripe_count * C_HASH64_STRIPE_BYTES;
+    }
+
+    for(; i + C_HASH64_WORD_BYTES <= size_bytes; i += C_HASH64_WORD_BYTES)
+    {
+        h = _mum(_read64(p + i) ^ C_HASH64_PRIME1, h ^ C_HASH64_PRIME2);
+    }
+
+    h = _mum(_read_tail(p + i, size_bytes - i) ^ C_HASH64_PRIME1, h ^ C_HASH64_PRIME2);
+
+    return _mum(h ^ C_HASH64_PRIME1, (uint64_t)size_bytes ^ C_HASH64_PRIME2);
 }
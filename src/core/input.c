@@ -1,18 +1,52 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "scieppend/core/input.h"
 
-#include "scieppend/core/cache_map.h"
-#include "scieppend/core/log.h"
+#include "scieppend/core/concurrent/spsc_queue.h"
 #include "scieppend/core/term.h"
 
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
 #include <string.h>
-#include <sys/select.h>
-#include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <threads.h>
 #include <unistd.h>
 
-static const char* C_ARROW_UP            = "\033[A";
-static const char* C_ARROW_DOWN          = "\033[B";
-static const char* C_ARROW_RIGHT         = "\033[C";
-static const char* C_ARROW_LEFT          = "\033[D";
+// CONSTS
+
+#define C_KEY_QUEUE_CAPACITY 256
+#define C_READ_BUFFER_SIZE 256
+#define C_KEYCODE_COUNT (KEYCODE_SPECIAL_RANGE_END + 1)
+
+// How long to wait for the rest of an escape sequence before treating the escape as a key press
+#define C_ESCAPE_TIMEOUT_MS 25
+
+#define C_ESC '\033'
+#define C_CSI '['
+#define C_SS3 'O'
+
+struct EscapeSequence
+{
+    const char*  sequence;
+    enum KeyCode key;
+};
+
+// Cursor keys are sent as CSI normally, or SS3 when the terminal is in application mode
+static const struct EscapeSequence C_ESCAPE_SEQUENCES[] =
+{
+    { "\033[A", KEYCODE_ARROW_UP },
+    { "\033[B", KEYCODE_ARROW_DOWN },
+    { "\033[C", KEYCODE_ARROW_RIGHT },
+    { "\033[D", KEYCODE_ARROW_LEFT },
+    { "\033OA", KEYCODE_ARROW_UP },
+    { "\033OB", KEYCODE_ARROW_DOWN },
+    { "\033OC", KEYCODE_ARROW_RIGHT },
+    { "\033OD", KEYCODE_ARROW_LEFT }
+};
+
 //static const char* C_CTRL_ARROW_UP    = "\003[1;5A";
 //static const char* C_CTRL_ARROW_DOWN  = "\003[1;5B";
 //static const char* C_CTRL_ARROW_RIGHT = "\003[1;5C";
@@ -20,63 +54,240 @@ static const char* C_ARROW_LEFT          = "\033[D";
 
 static struct _InputManager
 {
-    struct CacheMap pressed;
+    // Written by the input thread, drained by input_poll()
+    struct SPSCQueue key_queue;
+
+    // Keys drained by the last input_poll(), in the order they were typed
+    enum KeyCode keys[C_KEY_QUEUE_CAPACITY];
+    int          key_count;
+    bool         pressed[C_KEYCODE_COUNT];
+
+    // Owned by the input thread
+    thrd_t             thread;
+    int                epoll_fd;
+    int                wake_fd;
+    struct InputParser parser;
 } _input_manager;
 
-static enum KeyCode _handle_escape_sequence(char buf[8])
+// INTERNAL FUNCS
+
+static enum KeyCode _handle_escape_sequence(const char* sequence, int length)
 {
-    if(strcmp(buf, C_ARROW_UP) == 0)
+    for(int i = 0; i < (int)(sizeof(C_ESCAPE_SEQUENCES) / sizeof(C_ESCAPE_SEQUENCES[0])); ++i)
     {
-        return KEYCODE_ARROW_UP;
+        const struct EscapeSequence* escape = &C_ESCAPE_SEQUENCES[i];
+        if((int)strlen(escape->sequence) == length && memcmp(escape->sequence, sequence, length) == 0)
+        {
+            return escape->key;
+        }
     }
 
-    if(strcmp(buf, C_ARROW_DOWN) == 0)
+    return KEYCODE_UNKNOWN;
+}
+
+static enum KeyCode _handle_char(char c)
+{
+    // Simple ASCII code to handle
+    if((c >= KEYCODE_CHAR_RANGE_START && c <= KEYCODE_CHAR_RANGE_END) || c == KEYCODE_ENTER || c == KEYCODE_ESC || c == KEYCODE_BACKSPACE)
     {
-        return KEYCODE_ARROW_DOWN;
+        return c;
     }
 
-    if(strcmp(buf, C_ARROW_RIGHT) == 0)
+    return KEYCODE_UNKNOWN;
+}
+
+static void _add_key(struct InputParser* parser, enum KeyCode key)
+{
+    if(key == KEYCODE_UNKNOWN || parser->key_count == INPUT_PARSER_BUFFER_SIZE)
     {
-        return KEYCODE_ARROW_RIGHT;
+        return;
     }
 
-    if(strcmp(buf, C_ARROW_LEFT) == 0)
+    parser->keys[parser->key_count++] = key;
+}
+
+/* Parses as many whole key presses from the pending bytes as possible.
+ * A trailing escape sequence that may not have fully arrived yet is left pending, unless flush is set, in which case
+ * its escape is taken as the escape key.
+ */
+static void _parse_pending(struct InputParser* parser, bool flush)
+{
+    const char* bytes = parser->pending;
+    int length = parser->pending_length;
+    int i = 0;
+
+    while(i < length)
     {
-        return KEYCODE_ARROW_LEFT;
+        if(bytes[i] != C_ESC)
+        {
+            _add_key(parser, _handle_char(bytes[i]));
+            ++i;
+            continue;
+        }
+
+        if(i + 1 == length)
+        {
+            if(!flush)
+            {
+                break;
+            }
+
+            _add_key(parser, KEYCODE_ESC);
+            ++i;
+            continue;
+        }
+
+        if(bytes[i + 1] != C_CSI && bytes[i + 1] != C_SS3)
+        {
+            // Escape followed by a normal key, e.g. alt + key
+            _add_key(parser, KEYCODE_ESC);
+            ++i;
+            continue;
+        }
+
+        // Sequence runs until a final byte in the range @ to ~, SS3 always has exactly one
+        int end = i + 2;
+        if(bytes[i + 1] == C_CSI)
+        {
+            while(end < length && (bytes[end] < '@' || bytes[end] > '~'))
+            {
+                ++end;
+            }
+        }
+
+        if(end >= length)
+        {
+            if(!flush)
+            {
+                break;
+            }
+
+            _add_key(parser, KEYCODE_ESC);
+            ++i;
+            continue;
+        }
+
+        _add_key(parser, _handle_escape_sequence(bytes + i, end - i + 1));
+        i = end + 1;
     }
 
-    return KEYCODE_UNKNOWN;
+    memmove(parser->pending, bytes + i, length - i);
+    parser->pending_length = length - i;
+}
+
+/* Queues the keys from the last feed or flush.
+ * If the game has stopped draining the queue, newer keys are dropped rather than blocking on it.
+ */
+static void _queue_parsed_keys(void)
+{
+    for(int i = 0; i < _input_manager.parser.key_count; ++i)
+    {
+        spsc_queue_push(&_input_manager.key_queue, &_input_manager.parser.keys[i]);
+    }
 }
 
-static enum KeyCode _poll(void)
+/* Main loop for the input thread.
+ * Blocks until stdin has bytes or input_uninit() wakes it to exit.
+ */
+static int _input_thread_update([[maybe_unused]] void* _)
 {
-    struct timeval tv = { 0, 0 };
-    fd_set fds;
-    FD_ZERO(&fds);
-    FD_SET(STDIN_FILENO, &fds);
+    // Resizing is handled on the game thread, which must be the one interrupted by it
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGWINCH);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
 
-    // Check non-blocking for input
-    if(select(STDIN_FILENO + 1, &fds, NULL, NULL, &tv) > 0)
+    struct epoll_event event;
+    char buffer[C_READ_BUFFER_SIZE];
+    while(true)
     {
-        char buf[8];
-        int buflen = read(STDIN_FILENO, buf, sizeof(buf) - 1);
+        int timeout = input_parser_has_pending(&_input_manager.parser) ? C_ESCAPE_TIMEOUT_MS : -1;
+        int count = epoll_wait(_input_manager.epoll_fd, &event, 1, timeout);
 
-        if (buflen == 1)
+        if(count < 0)
         {
-            // Simple ASCII code to handle
-            if((buf[0] >= KEYCODE_CHAR_RANGE_START && buf[0] <= KEYCODE_CHAR_RANGE_END) || buf[0] == KEYCODE_ENTER || buf[0] == KEYCODE_ESC || buf[0] == KEYCODE_BACKSPACE)
+            if(errno == EINTR)
             {
-                return buf[0];
+                continue;
             }
 
-            return KEYCODE_UNKNOWN;
+            // Waiting itself failed, so no more input can be read
+            break;
         }
 
-        // If buffer length is > 1 from a single char, it must be an escape key or special character of some sort
-        return _handle_escape_sequence(buf);
+        if(count == 0)
+        {
+            // Nothing followed a partial escape sequence, so it was a key press
+            input_parser_flush(&_input_manager.parser);
+            _queue_parsed_keys();
+            continue;
+        }
+
+        if(event.data.fd == _input_manager.wake_fd)
+        {
+            break;
+        }
+
+        int read_length = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if(read_length <= 0)
+        {
+            // Stdin closed, so there will be no more input
+            break;
+        }
+
+        input_parser_feed(&_input_manager.parser, buffer, read_length);
+        _queue_parsed_keys();
     }
 
-    return KEYCODE_UNKNOWN;
+    return 0;
+}
+
+static void _add_epoll_fd(int fd)
+{
+    struct epoll_event event = { .events = EPOLLIN, .data.fd = fd };
+    epoll_ctl(_input_manager.epoll_fd, EPOLL_CTL_ADD, fd, &event);
+}
+
+// EXTERNAL FUNCS
+
+void input_parser_init(struct InputParser* parser)
+{
+    parser->pending_length = 0;
+    parser->key_count = 0;
+}
+
+void input_parser_feed(struct InputParser* parser, const char* bytes, int length)
+{
+    parser->key_count = 0;
+
+    while(length > 0)
+    {
+        if(parser->pending_length == INPUT_PARSER_BUFFER_SIZE)
+        {
+            // An escape sequence that never ends, give up on it
+            _parse_pending(parser, true);
+        }
+
+        int space = INPUT_PARSER_BUFFER_SIZE - parser->pending_length;
+        int chunk = length < space ? length : space;
+        memcpy(parser->pending + parser->pending_length, bytes, chunk);
+        parser->pending_length += chunk;
+        bytes += chunk;
+        length -= chunk;
+
+        _parse_pending(parser, false);
+    }
+}
+
+void input_parser_flush(struct InputParser* parser)
+{
+    parser->key_count = 0;
+    _parse_pending(parser, true);
+}
+
+bool input_parser_has_pending(const struct InputParser* parser)
+{
+    return parser->pending_length > 0;
 }
 
 bool input_get_key(enum KeyCode key)
@@ -84,27 +295,64 @@ bool input_get_key(enum KeyCode key)
     if (key == KEYCODE_UNKNOWN)
     {
         // If unknown, return if any key is pressed.
-        return cache_map_count(&_input_manager.pressed) > 0;
+        return _input_manager.key_count > 0;
+    }
+
+    if(key < 0 || key >= C_KEYCODE_COUNT)
+    {
+        return false;
     }
-    return cache_map_get(&_input_manager.pressed, &key, sizeof(enum KeyCode)) != NULL;
+
+    return _input_manager.pressed[key];
+}
+
+const enum KeyCode* input_get_keys(int* count)
+{
+    *count = _input_manager.key_count;
+    return _input_manager.keys;
 }
 
 void input_poll(void)
 {
-    cache_map_clear(&_input_manager.pressed);
-    enum KeyCode kc = _poll();
-    if(kc != KEYCODE_UNKNOWN)
+    for(int i = 0; i < _input_manager.key_count; ++i)
     {
-        cache_map_add(&_input_manager.pressed, &kc, sizeof(enum KeyCode), &kc);
+        _input_manager.pressed[_input_manager.keys[i]] = false;
+    }
+
+    _input_manager.key_count = 0;
+
+    enum KeyCode key;
+    while(_input_manager.key_count < C_KEY_QUEUE_CAPACITY && spsc_queue_pop(&_input_manager.key_queue, &key))
+    {
+        _input_manager.keys[_input_manager.key_count++] = key;
+        _input_manager.pressed[key] = true;
     }
 }
 
 void input_init(void)
 {
-    cache_map_init(&_input_manager.pressed, sizeof(enum KeyCode), 4, NULL, NULL);
+    memset(&_input_manager.pressed, 0, sizeof(_input_manager.pressed));
+    _input_manager.key_count = 0;
+    input_parser_init(&_input_manager.parser);
+
+    spsc_queue_init(&_input_manager.key_queue, sizeof(enum KeyCode), C_KEY_QUEUE_CAPACITY);
+
+    _input_manager.epoll_fd = epoll_create1(0);
+    _input_manager.wake_fd = eventfd(0, 0);
+    _add_epoll_fd(STDIN_FILENO);
+    _add_epoll_fd(_input_manager.wake_fd);
+
+    thrd_create(&_input_manager.thread, &_input_thread_update, NULL);
 }
 
 void input_uninit(void)
 {
-    cache_map_uninit(&_input_manager.pressed);
+    uint64_t wake = 1;
+    write(_input_manager.wake_fd, &wake, sizeof(wake));
+    thrd_join(_input_manager.thread, NULL);
+
+    close(_input_manager.wake_fd);
+    close(_input_manager.epoll_fd);
+
+    spsc_queue_uninit(&_input_manager.key_queue);
 }
@@ -1,5 +1,7 @@
 #include "scieppend/core/log.h"
 
+#include "scieppend/core/string_builder.h"
+
 #include <stdarg.h>
 #include <stdio.h>
 
@@ -7,6 +9,9 @@
 
 #define C_LOG_CHANNELS_MAX 32
 
+// Lines up to this long are built on the stack, so logging only allocates for long messages
+#define C_LOG_LINE_INLINE_SIZE 256
+
 static const char* C_MSGHIST_FNAME = "msghist.log";
 static const char* C_DEBUGLOG_FNAME = "debug.log";
 static const char* C_TESTLOG_FNAME = "test.log";
@@ -27,13 +32,18 @@ static struct _LogChannel s_log_channels[C_LOG_CHANNELS_MAX];
 
 static void _log_msg(struct _LogChannel* channel, const char* msg)
 {
-    for(int i = 0; i < channel->indent; ++i)
-    {
-        fprintf(channel->file, "\t");
-    }
+    char line_buffer[C_LOG_LINE_INLINE_SIZE];
+    struct StringBuilder line;
+    string_builder_init_buffer(&line, line_buffer, sizeof(line_buffer));
 
-    fprintf(channel->file, "%s\n", msg);
+    string_builder_append_repeat(&line, '\t', channel->indent);
+    string_builder_append(&line, msg);
+    string_builder_append_char(&line, '\n');
+
+    fwrite(string_builder_cstr(&line), 1, string_builder_size(&line), channel->file);
     fflush(channel->file);
+
+    string_builder_uninit(&line);
 }
 
 // EXTERNAL FUNCS
@@ -81,11 +91,16 @@ void log_format_msg(LogChannels channels, const char* format, ...)
     va_list args;
     va_start(args, format);
 
-    char msg[256];
-    vsnprintf(msg, 256, format, args);
-    log_msg(channels, msg);
+    char message_buffer[C_LOG_LINE_INLINE_SIZE];
+    struct StringBuilder message;
+    string_builder_init_buffer(&message, message_buffer, sizeof(message_buffer));
+
+    string_builder_append_vformat(&message, format, args);
+    log_msg(channels, string_builder_cstr(&message));
 
     va_end(args);
+
+    string_builder_uninit(&message);
 }
 
 void uninit_logs(void)
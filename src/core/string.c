@@ -1,11 +1,134 @@
 #include "scieppend/core/string.h"
 
+#include "scieppend/core/array.h"
+#include "scieppend/core/cache_map_threadsafe.h"
 #include "scieppend/core/hash.h"
+#include "scieppend/core/rw_lock.h"
 
 #include <stdarg.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <threads.h>
+
+const int C_NULL_STRING_ID = 0;
+
+struct _InternedString
+{
+    int   id;
+    char* chars;
+};
+
+static struct _InternTable
+{
+    struct CacheMap_ThreadSafe strings; // CacheMap_ThreadSafe<_InternedString>, keyed by characters
+    struct Array               by_id;   // Array<_InternedString*>, index is id - 1
+} _intern_table;
+
+static once_flag _intern_table_once = ONCE_FLAG_INIT;
+
+// INTERNAL FUNCS
+
+static inline bool _is_inline(const struct string* str)
+{
+    return str->capacity == STRING_INLINE_CAPACITY;
+}
+
+static inline char* _data(struct string* str)
+{
+    return _is_inline(str) ? str->inline_buffer : str->heap_buffer;
+}
+
+// Make room for at least size characters plus the terminator, keeping the current characters
+static void _reserve(struct string* str, int size)
+{
+    if(size <= str->capacity)
+    {
+        return;
+    }
+
+    char* new_buffer = malloc(size + 1);
+    if(!new_buffer)
+    {
+        abort();
+    }
+
+    memcpy(new_buffer, _data(str), str->size + 1);
+
+    if(!_is_inline(str))
+    {
+        free(str->heap_buffer);
+    }
+
+    str->heap_buffer = new_buffer;
+    str->capacity = size;
+}
+
+static void _set_chars(struct string* str, const char* chars, int size)
+{
+    _reserve(str, size);
+
+    char* data = _data(str);
+    memcpy(data, chars, size);
+    data[size] = '\0';
+
+    str->size = size;
+    str->hash = hash64(data, size);
+}
+
+static void _interned_string_uninit_wrapper(void* interned)
+{
+    free(((struct _InternedString*)interned)->chars);
+}
+
+static void _intern_table_uninit(void)
+{
+    array_uninit(&_intern_table.by_id);
+    cache_map_ts_uninit(&_intern_table.strings);
+}
+
+// The table lives as long as the program, so ids stay valid and can be kept anywhere
+static void _intern_table_init(void)
+{
+    cache_map_ts_init(&_intern_table.strings, sizeof(struct _InternedString), 64, NULL, &_interned_string_uninit_wrapper);
+    array_init(&_intern_table.by_id, sizeof(struct _InternedString*), 64, NULL, NULL);
+    atexit(&_intern_table_uninit);
+}
+
+// Find or add the characters in the intern table, using the precomputed hash64() of them
+static int _intern(const char* chars, int size, unsigned long long chars_hash)
+{
+    call_once(&_intern_table_once, &_intern_table_init);
+
+    const struct _InternedString* interned = cache_map_ts_get_with_hash(&_intern_table.strings, chars, size, chars_hash);
+    if(interned)
+    {
+        return interned->id;
+    }
+
+    cache_map_ts_lock(&_intern_table.strings, WRITE);
+
+    // Another thread may have interned it between the locks
+    struct _InternedString* new_interned = cache_map_get_with_hash(&_intern_table.strings.map, chars, size, chars_hash);
+    if(!new_interned)
+    {
+        struct _InternedString init;
+        init.id = array_count(&_intern_table.by_id) + 1;
+        init.chars = malloc(size + 1);
+        memcpy(init.chars, chars, size);
+        init.chars[size] = '\0';
+
+        cache_map_add(&_intern_table.strings.map, init.chars, size, &init);
+        new_interned = cache_map_get_with_hash(&_intern_table.strings.map, chars, size, chars_hash);
+        array_add(&_intern_table.by_id, &new_interned);
+    }
+
+    int id = new_interned->id;
+
+    cache_map_ts_unlock(&_intern_table.strings, WRITE);
+
+    return id;
+}
 
 // EXTERNAL FUNCS
 
@@ -24,15 +147,35 @@ void string_free(struct string* str)
 
 void string_init(struct string* str, const char* initial)
 {
-    str->size = strlen(initial);
-    str->buffer = malloc(str->size + 1);
-    snprintf(str->buffer, str->size + 1, "%s", initial);
+    str->size = 0;
+    str->capacity = STRING_INLINE_CAPACITY;
+    str->inline_buffer[0] = '\0';
+    _set_chars(str, initial, strlen(initial));
+}
+
+void string_init_take_buffer(struct string* str, char* buffer, int size, int capacity)
+{
+    str->heap_buffer = buffer;
+    str->size = size;
+    str->capacity = capacity;
+    str->hash = hash64(buffer, size);
 }
 
 void string_uninit(struct string* str)
 {
+    if(!_is_inline(str))
+    {
+        free(str->heap_buffer);
+    }
+
     str->size = 0;
-    free(str->buffer);
+    str->capacity = STRING_INLINE_CAPACITY;
+    str->inline_buffer[0] = '\0';
+}
+
+const char* string_cstr(const struct string* str)
+{
+    return _is_inline(str) ? str->inline_buffer : str->heap_buffer;
 }
 
 int string_size(struct string* str)
@@ -42,14 +185,14 @@ int string_size(struct string* str)
 
 void string_printf(struct string* str)
 {
-    printf(str->buffer);
+    printf("%s", string_cstr(str));
 }
 
 int string_rfindi(struct string* str, const char needle, size_t start)
 {
-    const char* haystack = str->buffer;
+    const char* haystack = string_cstr(str);
 
-    if(strlen(haystack) < start)
+    if((size_t)str->size < start)
     {
         return -1;
     }
@@ -72,39 +215,70 @@ int string_rfindi(struct string* str, const char needle, size_t start)
 
 void string_set(struct string* str, const char* value)
 {
-    int value_len = strlen(value);
-    if(value_len > str->size)
-    {
-        str->buffer = realloc(str->buffer, value_len+1);
-        str->size = value_len;
-    }
-
-    snprintf(str->buffer, str->size, "%s", value);
+    _set_chars(str, value, strlen(value));
 }
 
 void string_format(struct string* str, const char* format, ...)
 {
     va_list args;
-    va_list args_copy;
-    va_copy(args_copy, args);
 
-    va_start(args_copy, format);
-    int buffer_size = vsnprintf(NULL, 0, format, args_copy);
-    va_end(args_copy);
+    va_start(args, format);
+    int buffer_size = vsnprintf(NULL, 0, format, args);
+    va_end(args);
 
-    if(buffer_size > str->size)
-    {
-        str->buffer = realloc(str->buffer, buffer_size + 1);
-        str->size = buffer_size;
-    }
+    _reserve(str, buffer_size);
 
     va_start(args, format);
-    vsnprintf(str->buffer, buffer_size + 1, format, args);
+    vsnprintf(_data(str), buffer_size + 1, format, args);
     va_end(args);
+
+    str->size = buffer_size;
+    str->hash = hash64(_data(str), buffer_size);
 }
 
 int string_hash(const struct string* str)
 {
-    int hashed = hash(str->buffer, str->size);
-    return hashed;
+    return (int)(unsigned int)(str->hash ^ (str->hash >> 32));
+}
+
+unsigned long long string_hash64(const struct string* str)
+{
+    return str->hash;
+}
+
+int string_intern(const struct string* str)
+{
+    return _intern(string_cstr(str), str->size, str->hash);
+}
+
+int string_intern_chars(const char* chars)
+{
+    int size = strlen(chars);
+    return _intern(chars, size, hash64(chars, size));
+}
+
+int string_intern_find(const struct string* str)
+{
+    call_once(&_intern_table_once, &_intern_table_init);
+
+    const struct _InternedString* interned = cache_map_ts_get_with_hash(&_intern_table.strings, string_cstr(str), str->size, str->hash);
+    return interned ? interned->id : C_NULL_STRING_ID;
+}
+
+const char* string_intern_get(int id)
+{
+    call_once(&_intern_table_once, &_intern_table_init);
+
+    const char* chars = NULL;
+
+    cache_map_ts_lock(&_intern_table.strings, READ);
+
+    if(id > 0 && id <= array_count(&_intern_table.by_id))
+    {
+        chars = (*(struct _InternedString**)array_get(&_intern_table.by_id, id - 1))->chars;
+    }
+
+    cache_map_ts_unlock(&_intern_table.strings, READ);
+
+    return chars;
 }
@@ -0,0 +1,238 @@
+#include "scieppend/core/string_builder.h"
+
+#include "scieppend/core/string.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int C_MIN_CAPACITY = 32;
+
+// Enough for the digits of any 32-bit value plus a sign
+#define C_INT_CHARS_MAX 11
+
+// INTERNAL FUNCS
+
+// Grow so that size more characters and the terminator fit
+static void _grow(struct StringBuilder* builder, int size)
+{
+    int required = builder->size + size + 1;
+    if(required <= builder->capacity)
+    {
+        return;
+    }
+
+    int new_capacity = builder->capacity < C_MIN_CAPACITY ? C_MIN_CAPACITY : builder->capacity;
+    while(new_capacity < required)
+    {
+        new_capacity <<= 1;
+    }
+
+    char* new_buffer = builder->owns_buffer ? realloc(builder->buffer, new_capacity) : malloc(new_capacity);
+    if(!new_buffer)
+    {
+        abort();
+    }
+
+    if(!builder->owns_buffer && builder->buffer)
+    {
+        memcpy(new_buffer, builder->buffer, builder->size + 1);
+    }
+
+    builder->buffer = new_buffer;
+    builder->capacity = new_capacity;
+    builder->owns_buffer = true;
+}
+
+// Write the digits of value ending just before end, and return a pointer to the first digit
+static char* _write_uint_backwards(char* end, unsigned int value)
+{
+    do
+    {
+        *--end = (char)('0' + (value % 10));
+        value /= 10;
+    }
+    while(value != 0);
+
+    return end;
+}
+
+// EXTERNAL FUNCS
+
+struct StringBuilder* string_builder_new(int capacity)
+{
+    struct StringBuilder* builder = malloc(sizeof(struct StringBuilder));
+    string_builder_init(builder, capacity);
+    return builder;
+}
+
+void string_builder_free(struct StringBuilder* builder)
+{
+    string_builder_uninit(builder);
+    free(builder);
+}
+
+void string_builder_init(struct StringBuilder* builder, int capacity)
+{
+    builder->buffer = NULL;
+    builder->size = 0;
+    builder->capacity = 0;
+    builder->owns_buffer = false;
+
+    if(capacity > 0)
+    {
+        _grow(builder, capacity);
+        builder->buffer[0] = '\0';
+    }
+}
+
+void string_builder_init_buffer(struct StringBuilder* builder, char* buffer, int capacity)
+{
+    builder->buffer = buffer;
+    builder->size = 0;
+    builder->capacity = capacity;
+    builder->owns_buffer = false;
+    buffer[0] = '\0';
+}
+
+void string_builder_uninit(struct StringBuilder* builder)
+{
+    if(builder->owns_buffer)
+    {
+        free(builder->buffer);
+    }
+
+    builder->buffer = NULL;
+    builder->size = 0;
+    builder->capacity = 0;
+    builder->owns_buffer = false;
+}
+
+const char* string_builder_cstr(const struct StringBuilder* builder)
+{
+    return builder->buffer ? builder->buffer : "";
+}
+
+int string_builder_size(const struct StringBuilder* builder)
+{
+    return builder->size;
+}
+
+void string_builder_clear(struct StringBuilder* builder)
+{
+    builder->size = 0;
+    if(builder->buffer)
+    {
+        builder->buffer[0] = '\0';
+    }
+}
+
+void string_builder_reserve(struct StringBuilder* builder, int size)
+{
+    _grow(builder, size);
+}
+
+void string_builder_append(struct StringBuilder* builder, const char* chars)
+{
+    string_builder_append_chars(builder, chars, strlen(chars));
+}
+
+void string_builder_append_chars(struct StringBuilder* builder, const char* chars, int size)
+{
+    _grow(builder, size);
+    memcpy(builder->buffer + builder->size, chars, size);
+    builder->size += size;
+    builder->buffer[builder->size] = '\0';
+}
+
+void string_builder_append_char(struct StringBuilder* builder, char c)
+{
+    _grow(builder, 1);
+    builder->buffer[builder->size++] = c;
+    builder->buffer[builder->size] = '\0';
+}
+
+void string_builder_append_repeat(struct StringBuilder* builder, char c, int count)
+{
+    if(count <= 0)
+    {
+        return;
+    }
+
+    _grow(builder, count);
+    memset(builder->buffer + builder->size, c, count);
+    builder->size += count;
+    builder->buffer[builder->size] = '\0';
+}
+
+void string_builder_append_int(struct StringBuilder* builder, int value)
+{
+    char digits[C_INT_CHARS_MAX];
+    char* end = digits + C_INT_CHARS_MAX;
+
+    // Negate as unsigned so INT_MIN does not overflow
+    unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    char* start = _write_uint_backwards(end, magnitude);
+    if(value < 0)
+    {
+        *--start = '-';
+    }
+
+    string_builder_append_chars(builder, start, end - start);
+}
+
+void string_builder_append_uint(struct StringBuilder* builder, unsigned int value)
+{
+    char digits[C_INT_CHARS_MAX];
+    char* end = digits + C_INT_CHARS_MAX;
+    char* start = _write_uint_backwards(end, value);
+
+    string_builder_append_chars(builder, start, end - start);
+}
+
+void string_builder_append_string(struct StringBuilder* builder, const struct string* str)
+{
+    string_builder_append_chars(builder, string_cstr(str), str->size);
+}
+
+void string_builder_append_format(struct StringBuilder* builder, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    string_builder_append_vformat(builder, format, args);
+    va_end(args);
+}
+
+void string_builder_append_vformat(struct StringBuilder* builder, const char* format, va_list args)
+{
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int size = vsnprintf(NULL, 0, format, args_copy);
+    va_end(args_copy);
+
+    if(size <= 0)
+    {
+        return;
+    }
+
+    _grow(builder, size);
+    vsnprintf(builder->buffer + builder->size, size + 1, format, args);
+    builder->size += size;
+}
+
+void string_builder_to_string(struct StringBuilder* builder, struct string* str)
+{
+    if(builder->size <= STRING_INLINE_CAPACITY || !builder->owns_buffer)
+    {
+        string_init(str, string_builder_cstr(builder));
+        string_builder_clear(builder);
+        return;
+    }
+
+    string_init_take_buffer(str, builder->buffer, builder->size, builder->capacity - 1);
+
+    builder->buffer = NULL;
+    builder->size = 0;
+    builder->capacity = 0;
+    builder->owns_buffer = false;
+}
@@ -9,7 +9,7 @@
 #define DEFAULT_ENTITIES_CAPACITY 64
 
 // Pre-computed hash of "__NullSystemType" string
-const int C_NULL_SYSTEM_TYPE = -764810385;
+const int C_NULL_SYSTEM_TYPE = -1361462198;
 
 enum _EntityOperation
 {
@@ -77,31 +77,29 @@ static void _system_remove_entity(struct System* system, EntityHandle entity_han
     }
 }
 
-static void _system_event_callback([[maybe_unused]] const struct Event* sender, void* observer_data, void* event_args)
+static void _system_on_entity_created([[maybe_unused]] const struct Event* sender, void* observer_data, const struct EntityEventArgs* args)
 {
-    struct System* system = observer_data;
-    enum ECSEventType event_type = ((struct ECSEventArgs*)event_args)->event_type;
+    _system_add_entity(observer_data, args->entity_handle);
+}
+EVENT_CHANNEL_OBSERVER_DEF(EntityEvent, _system_on_entity_created);
 
-    switch(event_type)
-    {
-        case EVENT_COMPONENT_ADDED:
-        case EVENT_ENTITY_CREATED:
-            {
-                struct EntityEventArgs* args = event_args;
-                _system_add_entity(system, args->entity_handle);
-            }
-            break;
-        case EVENT_COMPONENT_REMOVED:
-        case EVENT_ENTITY_DESTROYED:
-            {
-                struct EntityEventArgs* args = event_args;
-                _system_remove_entity(system, args->entity_handle);
-            }
-            break;
-        default:
-            break;
-    }
+static void _system_on_entity_destroyed([[maybe_unused]] const struct Event* sender, void* observer_data, const struct EntityEventArgs* args)
+{
+    _system_remove_entity(observer_data, args->entity_handle);
+}
+EVENT_CHANNEL_OBSERVER_DEF(EntityEvent, _system_on_entity_destroyed);
+
+static void _system_on_component_added([[maybe_unused]] const struct Event* sender, void* observer_data, const struct ComponentEventArgs* args)
+{
+    _system_add_entity(observer_data, args->base.entity_handle);
+}
+EVENT_CHANNEL_OBSERVER_DEF(ComponentEvent, _system_on_component_added);
+
+static void _system_on_component_removed([[maybe_unused]] const struct Event* sender, void* observer_data, const struct ComponentEventArgs* args)
+{
+    _system_remove_entity(observer_data, args->base.entity_handle);
 }
+EVENT_CHANNEL_OBSERVER_DEF(ComponentEvent, _system_on_component_removed);
 
 // ---------- EXTERNAL FUNCS ----------
 
@@ -114,11 +112,14 @@ struct System* system_new(struct ECSWorld* world, const struct string* name, con
 
 void system_init(struct System* system, struct ECSWorld* world, const struct string* name, const struct Array* required_components, SystemUpdateFn update_func)
 {
-    string_init(&system->name, name->buffer);
+    string_init(&system->name, string_cstr(name));
     system->state = SYSTEM_STATE_IDLE;
     system->world = world;
     system->update_func = update_func;
-    system->observer_handle = observer_create(system, &_system_event_callback);
+    system->entity_created_observer = observer_create(system, EVENT_CHANNEL_OBSERVER(_system_on_entity_created));
+    system->entity_destroyed_observer = observer_create(system, EVENT_CHANNEL_OBSERVER(_system_on_entity_destroyed));
+    system->component_added_observer = observer_create(system, EVENT_CHANNEL_OBSERVER(_system_on_component_added));
+    system->component_removed_observer = observer_create(system, EVENT_CHANNEL_OBSERVER(_system_on_component_removed));
     array_init(&system->required_components, sizeof(ComponentTypeHandle), array_count(required_components), NULL, NULL);
     array_ts_init(&system->entity_handles, sizeof(EntityHandle), DEFAULT_ENTITIES_CAPACITY, NULL, NULL);
     array_ts_init(&system->ecs_commands, sizeof(struct _EntityCommand), 8, NULL, NULL);
@@ -127,7 +128,7 @@ void system_init(struct System* system, struct ECSWorld* world, const struct str
     {
         ComponentTypeHandle component_type_handle = *(ComponentTypeHandle*)array_get(required_components, i);
         array_add(&system->required_components, &component_type_handle);
-        ecs_world_component_type_register_observer(world, component_type_handle, system->observer_handle);
+        ecs_world_component_type_register_observers(world, component_type_handle, system->component_added_observer, system->component_removed_observer);
     }
 }
 
@@ -150,10 +151,13 @@ void system_uninit(struct System* system)
     for(int i = 0; i < array_count(&system->required_components); ++i)
     {
         ComponentTypeHandle component_type_handle = *(ComponentTypeHandle*)array_get(&system->required_components, i);
-        ecs_world_component_type_deregister_observer(system->world, component_type_handle, system->observer_handle);
+        ecs_world_component_type_deregister_observers(system->world, component_type_handle, system->component_added_observer, system->component_removed_observer);
     }
 
-    observer_destroy(system->observer_handle);
+    observer_destroy(system->component_removed_observer);
+    observer_destroy(system->component_added_observer);
+    observer_destroy(system->entity_destroyed_observer);
+    observer_destroy(system->entity_created_observer);
     array_ts_uninit(&system->ecs_commands);
     array_ts_uninit(&system->entity_handles);
     array_uninit(&system->required_components);
@@ -1,16 +1,24 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "scieppend/core/term.h"
 
 #include "scieppend/core/bit_flags.h"
 #include "scieppend/core/colour.h"
+#include "scieppend/core/concurrent/futex.h"
+#include "scieppend/core/hash.h"
 #include "scieppend/core/log.h"
 
 #include <sys/ioctl.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <termios.h>
+#include <threads.h>
 #include <unistd.h>
 
 // CONSTS
@@ -31,7 +39,15 @@
 #define C_CURSOR         C_ESCAPE C_ESCAPE_KIND "?25"
 #define C_CURSOR_ON      C_CURSOR C_HIGH
 #define C_CURSOR_OFF     C_CURSOR C_LOW
-#define C_MOVE_FORMAT    C_ESCAPE C_ESCAPE_KIND "%d" C_SEP "%df"
+#define C_MOVE           C_ESCAPE C_ESCAPE_KIND
+#define C_MOVE_END       "f"
+#define C_SYNC_UPDATE     C_ESCAPE C_ESCAPE_KIND "?2026"
+#define C_SYNC_UPDATE_ON  C_SYNC_UPDATE C_HIGH
+#define C_SYNC_UPDATE_OFF C_SYNC_UPDATE C_LOW
+#define C_SCROLL_REGION_END "r"
+#define C_SCROLL_REGION_RESET C_ESCAPE C_ESCAPE_KIND C_SCROLL_REGION_END
+#define C_SCROLL_UP   "S"
+#define C_SCROLL_DOWN "T"
 
 #define C_FOREGROUND "38"
 #define C_BACKGROUND "48"
@@ -39,25 +55,87 @@
 #define C_DEFAULT_BACKGROUND "49"
 #define C_TRUE_COLOUR "2"
 #define C_NO_TRUE_COLOUR "5"
-#define C_RGB_FORMAT "%d" C_SEP "%d" C_SEP "%d"
-#define C_COLOUR(ground) ground C_SEP C_TRUE_COLOUR C_SEP C_RGB_FORMAT
-#define C_COLOUR_FG_FORMAT C_COLOUR(C_FOREGROUND)
-#define C_COLOUR_BG_FORMAT C_COLOUR(C_BACKGROUND)
+#define C_COLOUR(ground) ground C_SEP C_TRUE_COLOUR C_SEP
+#define C_COLOUR_FG C_COLOUR(C_FOREGROUND)
+#define C_COLOUR_BG C_COLOUR(C_BACKGROUND)
 #define C_COLOUR_DEFAULT_FG C_DEFAULT_FOREGROUND
 #define C_COLOUR_DEFAULT_BG C_DEFAULT_BACKGROUND
+#define C_PALETTE(ground) ground C_SEP C_NO_TRUE_COLOUR C_SEP
+#define C_PALETTE_FG C_PALETTE(C_FOREGROUND)
+#define C_PALETTE_BG C_PALETTE(C_BACKGROUND)
+
+// 16 colour codes, the bright half of the palette has its own range
+#define C_BASIC_FG 30
+#define C_BASIC_BG 40
+#define C_BRIGHT_FG 90
+#define C_BRIGHT_BG 100
+
+// Palette lookups are indexed by the top 5 bits of each channel
+#define C_COLOUR_LUT_BITS 5
+#define C_COLOUR_LUT_SIZE (1 << (C_COLOUR_LUT_BITS * 3))
+#define C_COLOUR_LUT_INDEX(rgb) ((((rgb)[0] >> 3) << 10) | (((rgb)[1] >> 3) << 5) | ((rgb)[2] >> 3))
 
-#define C_ATTRIBUTE_FORMAT "%d"
 #define C_DEFAULT C_ESCAPE C_ESCAPE_KIND "0" C_GRAPHICS_MODE
 
+#define C_MAX_UINT_DIGITS 10
+
+#define C_SYMBOL_ATTRIBUTE_MASK 0x0F
+#define C_SYMBOL_DEFAULT_FG_BIT (1 << 6)
+#define C_SYMBOL_DEFAULT_BG_BIT (1 << 7)
+#define C_SYMBOL_STYLE_SIZE offsetof(struct VTermSymbol, glyph)
+
+// Glyph ids below C_GLYPH_FIRST_REGISTERED are ASCII, the rest are handed out by term_register_glyph
+#define C_GLYPH_COUNT 256
+#define C_GLYPH_FIRST_REGISTERED 128
+#define C_GLYPH_MAX_BYTES 4
+#define C_GLYPH_CONTINUATION 0 // Right half of a wide glyph, written along with the glyph to its left
+
+// Triple buffered frames, the game draws into one while the render thread reads another and the third is handed between them
+#define C_FRAME_COUNT 3
+#define C_FRAME_INDEX_MASK 0x3
+#define C_FRAME_FRESH_BIT (1 << 2) // The handoff frame has been published and not yet taken by the render thread
+#define C_FRAME_STOP_BIT  (1 << 3) // The render thread should exit once there are no fresh frames
+
+// Largest number of rows a scroll is looked for over, and how many rows it has to save over repainting
+#define C_SCROLL_MAX_SHIFT 8
+#define C_SCROLL_MIN_ROWS 3
+
+// Writes a string literal without having to measure it at runtime.
+#define WRITE_LITERAL(literal) _write_bytes((literal), sizeof(literal) - 1)
+#define WRITE_DIRECT_LITERAL(literal) _write_direct((literal), sizeof(literal) - 1)
+
 // STRUCTS
 
 enum TextAttribute
 {
-    A_NONE       = 0,
-    A_BOLD       = 1,
-    A_UNDERSCORE = 4,
-    A_BLINK      = 5,
-    A_REVERSE    = 7
+    A_NONE           = 0,
+    A_BOLD           = 1,
+    A_UNDERSCORE     = 4,
+    A_BLINK          = 5,
+    A_REVERSE        = 7,
+    A_BOLD_OFF       = 22,
+    A_UNDERSCORE_OFF = 24,
+    A_BLINK_OFF      = 25,
+    A_REVERSE_OFF    = 27
+};
+
+/* Escape codes to set the colour of one ground in each colour mode.
+ */
+struct ColourCodes
+{
+    const char* true_colour;
+    int true_colour_length;
+    const char* palette;
+    int palette_length;
+    int basic;  // 16 colour code of the first basic colour
+    int bright; // 16 colour code of the first bright colour
+};
+
+struct TextAttributeCode
+{
+    TextAttributeFlags flag;
+    enum TextAttribute on;
+    enum TextAttribute off;
 };
 
 struct WriteBuffer
@@ -66,125 +144,892 @@ struct WriteBuffer
     int buffer_len;
 } write_buffer;
 
+/* Decimal representation of a value 0..255, so colour channels and attributes can be written with a copy.
+ */
+struct ByteString
+{
+    char chars[3];
+    unsigned char length;
+};
+
+/* Pre-encoded UTF-8 for a glyph, so rendering a cell is a copy.
+ */
+struct Glyph
+{
+    char bytes[C_GLYPH_MAX_BYTES];
+    unsigned char length;
+    unsigned char width; // Columns the glyph takes up on the terminal
+};
+
+/* A single 8 byte cell, so rows are small to scan and a cell compares as one word.
+ * Colours are stored as RGB888, a default colour is marked by a bit in flags and has zeroed channels.
+ */
 struct VTermSymbol
 {
-    struct Colour fg;
-    struct Colour bg;
-    TextAttributeFlags ta_flags;
-    char symbol;
-    bool redraw;
+    unsigned char fg[3];
+    unsigned char bg[3];
+    unsigned char flags; // TextAttributeFlags in the low bits, plus the C_SYMBOL_DEFAULT_*_BIT bits
+    unsigned char glyph; // Index into the glyph table
+};
+_Static_assert(sizeof(struct VTermSymbol) == 8, "VTermSymbol should pack into 8 bytes");
+
+/* Graphics state the terminal is currently in, used to only emit what changes between cells.
+ * The glyph is unused.
+ */
+typedef struct VTermSymbol SGRState;
+
+/* Rows top to bottom inclusive, whose content moves up by shift rows, or down if shift is negative.
+ */
+struct ScrollRegion
+{
+    int top;
+    int bottom;
+    int shift;
+};
+
+/* Where the cursor is left once a frame has been written, x is -1 to leave it after the last cell written.
+ * Kept with each frame, so the render thread is the only one writing to the terminal while it runs.
+ */
+struct FrameCursor
+{
+    int x;
+    int y;
+    bool visible;
 };
 
 struct VTerm
 {
     int width;
     int height;
-    struct VTermSymbol* symbols;
+    struct VTermSymbol* front; // What is currently displayed on the terminal
+    struct VTermSymbol* back;  // What will be displayed after the next refresh, always frames[write_frame]
+    struct VTermSymbol* frames[C_FRAME_COUNT];
+    struct FrameCursor frame_cursors[C_FRAME_COUNT];
+    struct FrameCursor front_cursor; // Where the last frame written left the cursor, and whether it is shown
+    unsigned long long* front_row_hashes; // hash64() of each front buffer row, kept up to date as the rows change
+    unsigned long long* frame_row_hashes; // Scratch space for scroll detection, owned by whichever thread renders
+    unsigned long long blank_row_hash;
+    int write_frame;           // Owned by the game thread
+    int read_frame;            // Owned by the render thread
+    atomic_int handoff_frame;  // Frame index plus C_FRAME_* bits
+    thrd_t render_thread;
+    bool render_thread_running;
     struct termios initial_state;
-    bool cursor;
+    enum TermColourMode colour_mode;
+    bool headless;             // Output goes to the sink rather than the tty
+    FILE* sink_file;           // Optional copy of headless output
+    struct TermSinkStats sink_stats;
 };
 
 // INTERNAL VARS
 
 static struct VTerm* vterm = NULL;
-static struct Colour C_DEFAULT_colour = { -1, -1, -1 };
+static struct ByteString byte_strings[256];
+static struct Glyph glyphs[C_GLYPH_COUNT];
+static int glyph_count = 0;
+static unsigned char colour_lut[C_COLOUR_LUT_SIZE]; // RGB to palette index for the current colour mode
+static const struct VTermSymbol C_BLANK_SYMBOL = { { 0, 0, 0 }, { 0, 0, 0 }, C_SYMBOL_DEFAULT_FG_BIT | C_SYMBOL_DEFAULT_BG_BIT, ' ' };
+static const SGRState C_DEFAULT_SGR_STATE = { { 0, 0, 0 }, { 0, 0, 0 }, C_SYMBOL_DEFAULT_FG_BIT | C_SYMBOL_DEFAULT_BG_BIT, C_GLYPH_CONTINUATION };
+static const struct TextAttributeCode C_ATTRIBUTE_CODES[] =
+{
+    { A_BOLD_BIT,       A_BOLD,       A_BOLD_OFF },
+    { A_UNDERSCORE_BIT, A_UNDERSCORE, A_UNDERSCORE_OFF },
+    { A_BLINK_BIT,      A_BLINK,      A_BLINK_OFF },
+    { A_REVERSE_BIT,    A_REVERSE,    A_REVERSE_OFF }
+};
+
+// xterm's defaults for the 16 basic colours
+static const struct Colour C_BASIC_PALETTE[16] =
+{
+    {   0,   0,   0 }, { 205,   0,   0 }, {   0, 205,   0 }, { 205, 205,   0 },
+    {   0,   0, 238 }, { 205,   0, 205 }, {   0, 205, 205 }, { 229, 229, 229 },
+    { 127, 127, 127 }, { 255,   0,   0 }, {   0, 255,   0 }, { 255, 255,   0 },
+    {  92,  92, 255 }, { 255,   0, 255 }, {   0, 255, 255 }, { 255, 255, 255 }
+};
+static const int C_CUBE_LEVELS[6] = { 0, 95, 135, 175, 215, 255 };
+static const struct ColourCodes C_FG_CODES = { C_COLOUR_FG, sizeof(C_COLOUR_FG) - 1, C_PALETTE_FG, sizeof(C_PALETTE_FG) - 1, C_BASIC_FG, C_BRIGHT_FG };
+static const struct ColourCodes C_BG_CODES = { C_COLOUR_BG, sizeof(C_COLOUR_BG) - 1, C_PALETTE_BG, sizeof(C_PALETTE_BG) - 1, C_BASIC_BG, C_BRIGHT_BG };
 
 // INTERNAL FUNCS
 
-static void _writef(const char* format, ...)
+static void _init_byte_strings(void)
 {
-    va_list args;
-    va_start(args, format);
+    for(int i = 0; i < 256; ++i)
+    {
+        struct ByteString* byte_string = &byte_strings[i];
+        byte_string->length = 0;
 
-    vsnprintf(write_buffer.buffer + write_buffer.buffer_len, C_PRINT_BUFFER_SIZE - write_buffer.buffer_len, format, args);
+        if(i >= 100)
+        {
+            byte_string->chars[byte_string->length++] = '0' + (i / 100);
+        }
 
-    va_end(args);
+        if(i >= 10)
+        {
+            byte_string->chars[byte_string->length++] = '0' + ((i / 10) % 10);
+        }
+
+        byte_string->chars[byte_string->length++] = '0' + (i % 10);
+    }
+}
+
+static void _write_bytes(const char* bytes, int length)
+{
+    if(write_buffer.buffer_len + length > C_PRINT_BUFFER_SIZE)
+    {
+        length = C_PRINT_BUFFER_SIZE - write_buffer.buffer_len;
+    }
 
-    int add_len = strlen(write_buffer.buffer + write_buffer.buffer_len);
 #ifdef DEBUG_LOG_TERMINAL
-    log_format_msg(LOG_DEBUG, "\t%s", write_buffer.buffer + write_buffer.buffer_len);
+    log_format_msg(LOG_DEBUG, "\t%.*s", length, bytes);
 #endif
-    write_buffer.buffer_len += add_len;
+    memcpy(write_buffer.buffer + write_buffer.buffer_len, bytes, length);
+    write_buffer.buffer_len += length;
+}
+
+static inline void _write_glyph(unsigned char glyph)
+{
+    _write_bytes(glyphs[glyph].bytes, glyphs[glyph].length);
+}
+
+static inline void _write_byte(int value)
+{
+    struct ByteString* byte_string = &byte_strings[value & 0xFF];
+    _write_bytes(byte_string->chars, byte_string->length);
+}
+
+static void _write_uint(unsigned int value)
+{
+    if(value < 256)
+    {
+        _write_byte(value);
+        return;
+    }
+
+    char digits[C_MAX_UINT_DIGITS];
+    int idx = C_MAX_UINT_DIGITS;
+
+    do
+    {
+        digits[--idx] = '0' + (value % 10);
+        value /= 10;
+    }
+    while(value > 0);
+
+    _write_bytes(digits + idx, C_MAX_UINT_DIGITS - idx);
 }
 
 static void _write_attribute(enum TextAttribute attribute, bool semicolon)
 {
     if(semicolon)
     {
-        _writef(C_SEP);
+        WRITE_LITERAL(C_SEP);
+    }
+
+    _write_byte(attribute);
+}
+
+static void _write_rgb(const unsigned char* rgb)
+{
+    struct ByteString* r = &byte_strings[rgb[0]];
+    struct ByteString* g = &byte_strings[rgb[1]];
+    struct ByteString* b = &byte_strings[rgb[2]];
+
+    _write_bytes(r->chars, r->length);
+    WRITE_LITERAL(C_SEP);
+    _write_bytes(g->chars, g->length);
+    WRITE_LITERAL(C_SEP);
+    _write_bytes(b->chars, b->length);
+}
+
+/* Colour of an xterm 256 colour palette entry, ignoring the themable first 16.
+ */
+static struct Colour _palette_256_colour(int index)
+{
+    if(index >= 232)
+    {
+        int level = 8 + (index - 232) * 10;
+        return (struct Colour){ level, level, level };
+    }
+
+    index -= 16;
+    return (struct Colour){ C_CUBE_LEVELS[index / 36], C_CUBE_LEVELS[(index / 6) % 6], C_CUBE_LEVELS[index % 6] };
+}
+
+/* Maps every 15 bit colour to the perceptually nearest palette entry for the colour mode.
+ */
+static void _build_colour_lut(enum TermColourMode mode)
+{
+    struct Colour palette[256];
+    int palette_first = 0;
+    int palette_count = 0;
+
+    if(mode == COLOUR_MODE_256)
+    {
+        palette_first = 16;
+        palette_count = 240;
+        for(int i = 0; i < palette_count; ++i)
+        {
+            palette[i] = _palette_256_colour(palette_first + i);
+        }
+    }
+    else
+    {
+        palette_count = 16;
+        memcpy(palette, C_BASIC_PALETTE, sizeof(C_BASIC_PALETTE));
     }
 
-    _writef(C_ATTRIBUTE_FORMAT, attribute);
+    for(int i = 0; i < C_COLOUR_LUT_SIZE; ++i)
+    {
+        // Sample the middle of the range of colours each entry covers
+        struct Colour colour = { ((i >> 10) << 3) | 4, (((i >> 5) & 0x1F) << 3) | 4, ((i & 0x1F) << 3) | 4 };
+
+        int best = 0;
+        int best_distance = colour_distance(&colour, &palette[0]);
+        for(int p = 1; p < palette_count; ++p)
+        {
+            int distance = colour_distance(&colour, &palette[p]);
+            if(distance < best_distance)
+            {
+                best = p;
+                best_distance = distance;
+            }
+        }
+
+        colour_lut[i] = palette_first + best;
+    }
 }
 
-static void _write_fg_colour(struct Colour* fg, bool semicolon)
+static void _write_colour(const unsigned char* rgb, const struct ColourCodes* codes)
+{
+    if(vterm->colour_mode == COLOUR_MODE_TRUE)
+    {
+        _write_bytes(codes->true_colour, codes->true_colour_length);
+        _write_rgb(rgb);
+        return;
+    }
+
+    int index = colour_lut[C_COLOUR_LUT_INDEX(rgb)];
+    if(vterm->colour_mode == COLOUR_MODE_256)
+    {
+        _write_bytes(codes->palette, codes->palette_length);
+        _write_byte(index);
+    }
+    else
+    {
+        _write_byte(index < 8 ? codes->basic + index : codes->bright + index - 8);
+    }
+}
+
+static void _write_fg_colour(const unsigned char* fg, bool is_default, bool semicolon)
 {
     if(semicolon)
     {
-        _writef(C_SEP);
+        WRITE_LITERAL(C_SEP);
     }
 
-    if(fg->r == -1)
+    if(is_default)
     {
-        _writef(C_DEFAULT_FOREGROUND);
+        WRITE_LITERAL(C_DEFAULT_FOREGROUND);
     }
     else
     {
-        _writef(C_COLOUR_FG_FORMAT, fg->r, fg->g, fg->b);
+        _write_colour(fg, &C_FG_CODES);
     }
 }
 
-static void _write_bg_colour(struct Colour* bg, bool semicolon)
+static void _write_bg_colour(const unsigned char* bg, bool is_default, bool semicolon)
 {
     if(semicolon)
     {
-        _writef(C_SEP);
+        WRITE_LITERAL(C_SEP);
     }
 
-    if(bg->r == -1)
+    if(is_default)
     {
-        _writef(C_DEFAULT_BACKGROUND);
+        WRITE_LITERAL(C_DEFAULT_BACKGROUND);
     }
     else
     {
-        _writef(C_COLOUR_BG_FORMAT, bg->r, bg->g, bg->b);
+        _write_colour(bg, &C_BG_CODES);
+    }
+}
+
+/* Writes a single graphics mode sequence containing only the parts of the symbol's style that differ from the
+ * current state, then updates the state. Writes nothing if the style is unchanged.
+ */
+static void _write_sgr_diff(SGRState* state, struct VTermSymbol* sym)
+{
+    unsigned char flags_changed = state->flags ^ sym->flags;
+    TextAttributeFlags ta_changed = flags_changed & C_SYMBOL_ATTRIBUTE_MASK;
+    bool fg_changed = (flags_changed & C_SYMBOL_DEFAULT_FG_BIT) || memcmp(state->fg, sym->fg, sizeof(sym->fg)) != 0;
+    bool bg_changed = (flags_changed & C_SYMBOL_DEFAULT_BG_BIT) || memcmp(state->bg, sym->bg, sizeof(sym->bg)) != 0;
+
+    if(ta_changed == A_NONE_BIT && !fg_changed && !bg_changed)
+    {
+        return;
+    }
+
+    bool semicolon = false;
+    WRITE_LITERAL(C_ESCAPE C_ESCAPE_KIND);
+
+    for(int i = 0; i < (int)(sizeof(C_ATTRIBUTE_CODES) / sizeof(C_ATTRIBUTE_CODES[0])); ++i)
+    {
+        const struct TextAttributeCode* code = &C_ATTRIBUTE_CODES[i];
+        if(ta_changed & code->flag)
+        {
+            _write_attribute((sym->flags & code->flag) ? code->on : code->off, semicolon);
+            semicolon = true;
+        }
+    }
+
+    if(fg_changed)
+    {
+        _write_fg_colour(sym->fg, sym->flags & C_SYMBOL_DEFAULT_FG_BIT, semicolon);
+        semicolon = true;
+    }
+
+    if(bg_changed)
+    {
+        _write_bg_colour(sym->bg, sym->flags & C_SYMBOL_DEFAULT_BG_BIT, semicolon);
+    }
+
+    WRITE_LITERAL(C_GRAPHICS_MODE);
+
+    memcpy(state, sym, C_SYMBOL_STYLE_SIZE);
+}
+
+static void _write_move_cursor(int x, int y)
+{
+    WRITE_LITERAL(C_MOVE);
+    _write_uint(y+1);
+    WRITE_LITERAL(C_SEP);
+    _write_uint(x+1);
+    WRITE_LITERAL(C_MOVE_END);
+}
+
+/* Counts and optionally saves headless output, returning the number of escape sequences in it.
+ */
+static unsigned long long _sink_write(const char* bytes, int length)
+{
+    unsigned long long escape_sequences = 0;
+    for(int i = 0; i < length; ++i)
+    {
+        if(bytes[i] == C_ESCAPE[0])
+        {
+            ++escape_sequences;
+        }
+    }
+
+    vterm->sink_stats.bytes += length;
+    vterm->sink_stats.escape_sequences += escape_sequences;
+
+    if(vterm->sink_file)
+    {
+        fwrite(bytes, 1, length, vterm->sink_file);
+    }
+
+    return escape_sequences;
+}
+
+/* Writes straight to the output, bypassing the frame buffer.
+ * Only for when the render thread is not running, since it would race with its writes and sink stats.
+ */
+static void _write_direct(const char* bytes, int length)
+{
+    if(vterm->headless)
+    {
+        _sink_write(bytes, length);
+    }
+    else
+    {
+        write(1, bytes, length);
     }
 }
 
 static void _flush(void)
 {
-    write(1, write_buffer.buffer, write_buffer.buffer_len);
+    if(vterm->headless)
+    {
+        vterm->sink_stats.frame_escape_sequences = _sink_write(write_buffer.buffer, write_buffer.buffer_len);
+        vterm->sink_stats.frame_bytes = write_buffer.buffer_len;
+        ++vterm->sink_stats.frames;
+    }
+    else if(write_buffer.buffer_len > 0)
+    {
+        write(1, write_buffer.buffer, write_buffer.buffer_len);
+    }
+
     write_buffer.buffer_len = 0;
 }
 
 static inline struct VTermSymbol* _term_get_symbol(int x, int y)
 {
-    return &vterm->symbols[y * vterm->width + x];
+    return &vterm->back[y * vterm->width + x];
+}
+
+static inline bool _symbol_equal(struct VTermSymbol* lhs, struct VTermSymbol* rhs)
+{
+    return memcmp(lhs, rhs, sizeof(struct VTermSymbol)) == 0;
+}
+
+/* Packs a colour into a cell's RGB888 channels, where a NULL colour leaves the cell's colour as it is.
+ */
+static inline void _set_symbol_colour(struct VTermSymbol* sym, unsigned char* channels, unsigned char default_bit, struct Colour* colour)
+{
+    if(!colour)
+    {
+        return;
+    }
+
+    if(colour->r == -1)
+    {
+        memset(channels, 0, 3);
+        sym->flags |= default_bit;
+    }
+    else
+    {
+        channels[0] = colour->r;
+        channels[1] = colour->g;
+        channels[2] = colour->b;
+        sym->flags &= ~default_bit;
+    }
+}
+
+static void _clear_symbols(struct VTermSymbol* symbols, int count)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        symbols[i] = C_BLANK_SYMBOL;
+    }
+}
+
+static struct VTermSymbol* _realloc_symbols(struct VTermSymbol* symbols, int count)
+{
+    struct VTermSymbol* new_symbols = realloc(symbols, count * sizeof(struct VTermSymbol));
+    if(!new_symbols)
+    {
+        // Couldn't realloc the memory, which means something bad has happened.
+        // Cannot really continue from this situation so just die.
+        abort();
+    }
+
+    _clear_symbols(new_symbols, count);
+    return new_symbols;
+}
+
+static inline unsigned long long _hash_row(struct VTermSymbol* row)
+{
+    return hash64((const char*)row, vterm->width * sizeof(struct VTermSymbol));
+}
+
+static void _hash_front_rows(void)
+{
+    for(int y = 0; y < vterm->height; ++y)
+    {
+        vterm->front_row_hashes[y] = _hash_row(&vterm->front[y * vterm->width]);
+    }
+}
+
+static inline bool _rows_equal(struct VTermSymbol* frame, int frame_y, int front_y)
+{
+    return vterm->frame_row_hashes[frame_y] == vterm->front_row_hashes[front_y] &&
+           memcmp(&frame[frame_y * vterm->width], &vterm->front[front_y * vterm->width], vterm->width * sizeof(struct VTermSymbol)) == 0;
+}
+
+/* Counts the rows of the frame that differ from the front buffer, stopping once there are enough to try scrolling.
+ */
+static int _count_changed_rows(struct VTermSymbol* frame)
+{
+    int row_bytes = vterm->width * sizeof(struct VTermSymbol);
+    int changed_rows = 0;
+
+    for(int y = 0; y < vterm->height && changed_rows < C_SCROLL_MIN_ROWS; ++y)
+    {
+        if(memcmp(&frame[y * vterm->width], &vterm->front[y * vterm->width], row_bytes) != 0)
+        {
+            ++changed_rows;
+        }
+    }
+
+    return changed_rows;
+}
+
+/* Looks for a band of rows that the front buffer only needs shifting up or down to match the frame.
+ * Returns false if there is none, or it would not save enough rows over repainting.
+ * The frame's row hashes must be up to date.
+ */
+static bool _find_scroll(struct VTermSymbol* frame, struct ScrollRegion* region)
+{
+    // Longest run of frame rows that match front rows at a fixed offset
+    int best_run = 0;
+    int best_end = 0;
+    int best_shift = 0;
+    for(int shift = -C_SCROLL_MAX_SHIFT; shift <= C_SCROLL_MAX_SHIFT; ++shift)
+    {
+        if(shift == 0)
+        {
+            continue;
+        }
+
+        int run = 0;
+        for(int y = 0; y < vterm->height; ++y)
+        {
+            int src = y + shift;
+            if(src < 0 || src >= vterm->height || !_rows_equal(frame, y, src))
+            {
+                run = 0;
+                continue;
+            }
+
+            if(++run > best_run)
+            {
+                best_run   = run;
+                best_end   = y;
+                best_shift = shift;
+            }
+        }
+    }
+
+    if(best_run == 0)
+    {
+        return false;
+    }
+
+    int start = best_end - best_run + 1;
+
+    // Rows that would not have needed repainting anyway are not saved by scrolling
+    int saved_rows = best_run;
+    for(int y = start; y <= best_end; ++y)
+    {
+        if(vterm->front_row_hashes[y] == vterm->frame_row_hashes[y])
+        {
+            --saved_rows;
+        }
+    }
+
+    if(saved_rows < C_SCROLL_MIN_ROWS)
+    {
+        return false;
+    }
+
+    region->shift  = best_shift;
+    region->top    = best_shift > 0 ? start : start + best_shift;
+    region->bottom = best_shift > 0 ? best_end + best_shift : best_end;
+    return true;
+}
+
+/* Scrolls the region on the terminal and applies the same shift to the front buffer.
+ * Rows scrolled in are blank, since every frame starts in the default graphics state.
+ */
+static void _write_scroll(struct ScrollRegion* region)
+{
+    int shift = region->shift > 0 ? region->shift : -region->shift;
+    int moved_rows = region->bottom - region->top + 1 - shift;
+    int width = vterm->width;
+
+    WRITE_LITERAL(C_ESCAPE C_ESCAPE_KIND);
+    _write_uint(region->top + 1);
+    WRITE_LITERAL(C_SEP);
+    _write_uint(region->bottom + 1);
+    WRITE_LITERAL(C_SCROLL_REGION_END C_ESCAPE C_ESCAPE_KIND);
+    _write_uint(shift);
+
+    int blank_top;
+    if(region->shift > 0)
+    {
+        WRITE_LITERAL(C_SCROLL_UP);
+        memmove(&vterm->front[region->top * width], &vterm->front[(region->top + shift) * width], moved_rows * width * sizeof(struct VTermSymbol));
+        blank_top = region->bottom - shift + 1;
+    }
+    else
+    {
+        WRITE_LITERAL(C_SCROLL_DOWN);
+        memmove(&vterm->front[(region->top + shift) * width], &vterm->front[region->top * width], moved_rows * width * sizeof(struct VTermSymbol));
+        blank_top = region->top;
+    }
+
+    _clear_symbols(&vterm->front[blank_top * width], shift * width);
+
+    // The row hashes move with the rows
+    if(region->shift > 0)
+    {
+        memmove(&vterm->front_row_hashes[region->top], &vterm->front_row_hashes[region->top + shift], moved_rows * sizeof(unsigned long long));
+    }
+    else
+    {
+        memmove(&vterm->front_row_hashes[region->top + shift], &vterm->front_row_hashes[region->top], moved_rows * sizeof(unsigned long long));
+    }
+
+    for(int y = blank_top; y < blank_top + shift; ++y)
+    {
+        vterm->front_row_hashes[y] = vterm->blank_row_hash;
+    }
+
+    // Resetting the region also homes the cursor, the next cell written always moves it explicitly
+    WRITE_LITERAL(C_SCROLL_REGION_RESET);
+}
+
+static unsigned long long* _realloc_row_hashes(unsigned long long* hashes, int count)
+{
+    unsigned long long* new_hashes = realloc(hashes, count * sizeof(unsigned long long));
+    if(!new_hashes)
+    {
+        abort();
+    }
+
+    return new_hashes;
+}
+
+/* Writes the cells of the given frame that differ from the front buffer, then flushes.
+ */
+static void _render_frame(int frame_index)
+{
+    struct VTermSymbol* frame = vterm->frames[frame_index];
+    struct FrameCursor* cursor = &vterm->frame_cursors[frame_index];
+
+    // Every refresh ends by resetting graphics mode, so each one starts from the default state.
+    // Adjacent cells with the same style then share a single escape sequence.
+    SGRState sgr_state = C_DEFAULT_SGR_STATE;
+    int lx = -1;
+    int ly = -1;
+
+    // Wrapped in a synchronized update so the terminal shows the frame all at once
+    int frame_start = write_buffer.buffer_len;
+    WRITE_LITERAL(C_SYNC_UPDATE_ON);
+
+    // Only hash the frame when enough rows changed for scrolling to be worth it, most frames change a few rows at most
+    bool frame_hashed = false;
+    if(_count_changed_rows(frame) >= C_SCROLL_MIN_ROWS)
+    {
+        for(int y = 0; y < vterm->height; ++y)
+        {
+            vterm->frame_row_hashes[y] = _hash_row(&frame[y * vterm->width]);
+        }
+        frame_hashed = true;
+
+        struct ScrollRegion region;
+        if(_find_scroll(frame, &region))
+        {
+            _write_scroll(&region);
+        }
+    }
+
+    for(int y = 0; y < vterm->height; ++y)
+    {
+        struct VTermSymbol* front_row = &vterm->front[y * vterm->width];
+        struct VTermSymbol* back_row  = &frame[y * vterm->width];
+
+        if(memcmp(front_row, back_row, vterm->width * sizeof(struct VTermSymbol)) == 0)
+        {
+            continue;
+        }
+
+        for(int x = 0; x < vterm->width; ++x)
+        {
+            struct VTermSymbol* sym = &back_row[x];
+
+            if(sym->glyph == C_GLYPH_CONTINUATION)
+            {
+                continue;
+            }
+
+            // A wide glyph is redrawn if either of its halves changed, or if it is replacing one
+            bool wide = glyphs[sym->glyph].width == 2;
+            bool was_wide = glyphs[front_row[x].glyph].width == 2;
+            bool pair_changed = (wide || was_wide) && x + 1 < vterm->width && !_symbol_equal(&front_row[x + 1], &back_row[x + 1]);
+
+            if(_symbol_equal(&front_row[x], sym) && !pair_changed)
+            {
+                continue;
+            }
+
+            // Move to
+            if (x != lx + 1 || y != ly)
+            {
+                _write_move_cursor(x, y);
+            }
+
+            lx = wide ? x + 1 : x;
+            ly = y;
+
+            _write_sgr_diff(&sgr_state, sym);
+
+            // Write symbol
+            _write_glyph(sym->glyph);
+        }
+
+        memcpy(front_row, back_row, vterm->width * sizeof(struct VTermSymbol));
+        vterm->front_row_hashes[y] = frame_hashed ? vterm->frame_row_hashes[y] : _hash_row(front_row);
+    }
+
+    // Reset term attributes
+    if(memcmp(&sgr_state, &C_DEFAULT_SGR_STATE, C_SYMBOL_STYLE_SIZE) != 0)
+    {
+        WRITE_LITERAL(C_DEFAULT);
+    }
+
+    // Anything written above has moved the cursor, so it needs putting back
+    bool cursor_moved = write_buffer.buffer_len != frame_start + (int)(sizeof(C_SYNC_UPDATE_ON) - 1);
+    if(cursor->x >= 0 && (cursor_moved || cursor->x != vterm->front_cursor.x || cursor->y != vterm->front_cursor.y))
+    {
+        _write_move_cursor(cursor->x, cursor->y);
+    }
+    if(cursor->visible != vterm->front_cursor.visible)
+    {
+        if(cursor->visible)
+        {
+            WRITE_LITERAL(C_CURSOR_ON);
+        }
+        else
+        {
+            WRITE_LITERAL(C_CURSOR_OFF);
+        }
+    }
+
+    vterm->front_cursor = *cursor;
+
+    if(write_buffer.buffer_len == frame_start + (int)(sizeof(C_SYNC_UPDATE_ON) - 1))
+    {
+        // Nothing changed, so don't send an empty update
+        write_buffer.buffer_len = frame_start;
+    }
+    else
+    {
+        WRITE_LITERAL(C_SYNC_UPDATE_OFF);
+    }
+
+    _flush();
+}
+
+/* Hands the back buffer to the render thread, replacing any frame it has not taken yet.
+ * The game thread carries on drawing into a copy, since callers only redraw what changes.
+ */
+static void _publish_frame(void)
+{
+    int published = vterm->write_frame;
+    int previous = atomic_exchange_explicit(&vterm->handoff_frame, published | C_FRAME_FRESH_BIT, memory_order_acq_rel);
+    futex_wake(&vterm->handoff_frame, 1);
+
+    vterm->write_frame = previous & C_FRAME_INDEX_MASK;
+    vterm->back = vterm->frames[vterm->write_frame];
+    memcpy(vterm->back, vterm->frames[published], vterm->width * vterm->height * sizeof(struct VTermSymbol));
+    vterm->frame_cursors[vterm->write_frame] = vterm->frame_cursors[published];
 }
 
-static inline bool _should_redraw(struct VTermSymbol* symbol, char new_symbol, struct Colour* new_fg, struct Colour* new_bg, TextAttributeFlags new_ta_flags)
+/* Main loop for the render thread.
+ * Waits for a fresh frame, swaps it with the frame last rendered and writes it out.
+ */
+static int _render_thread_update([[maybe_unused]] void* _)
 {
-    if(symbol->symbol != new_symbol)
+    // Resizing is handled on the game thread, which must be the one interrupted by it
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGWINCH);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    int handoff = atomic_load_explicit(&vterm->handoff_frame, memory_order_acquire);
+    while(true)
     {
-        return true;
+        if(!(handoff & C_FRAME_FRESH_BIT))
+        {
+            if(handoff & C_FRAME_STOP_BIT)
+            {
+                break;
+            }
+
+            futex_wait(&vterm->handoff_frame, handoff);
+            handoff = atomic_load_explicit(&vterm->handoff_frame, memory_order_acquire);
+            continue;
+        }
+
+        int desired = vterm->read_frame | (handoff & C_FRAME_STOP_BIT);
+        if(atomic_compare_exchange_weak_explicit(&vterm->handoff_frame, &handoff, desired, memory_order_acq_rel, memory_order_acquire))
+        {
+            vterm->read_frame = handoff & C_FRAME_INDEX_MASK;
+            _render_frame(vterm->read_frame);
+            handoff = desired;
+        }
     }
 
-    if(new_fg && !colour_equal(&symbol->fg, new_fg))
+    return 0;
+}
+
+static void _init_glyphs(void)
+{
+    for(int i = 0; i < C_GLYPH_COUNT; ++i)
     {
-        return true;
+        // Unregistered ids write their raw byte, as symbols did before glyphs were added
+        glyphs[i].bytes[0] = (char)i;
+        glyphs[i].length = 1;
+        glyphs[i].width = 1;
     }
 
-    if(new_bg && !colour_equal(&symbol->bg, new_bg))
+    glyphs[C_GLYPH_CONTINUATION].length = 0;
+    glyphs[C_GLYPH_CONTINUATION].width = 0;
+
+    glyph_count = C_GLYPH_FIRST_REGISTERED;
+}
+
+/* Sets the glyph of a back buffer cell, keeping wide glyphs and their continuation cells in pairs.
+ * A wide glyph in the last column is replaced with a space.
+ */
+static void _set_glyph(int x, int y, unsigned char glyph)
+{
+    struct VTermSymbol* sym = _term_get_symbol(x, y);
+
+    // Whatever is overwritten here must not leave half a wide glyph behind
+    if(sym->glyph == C_GLYPH_CONTINUATION && x > 0)
     {
-        return true;
+        _term_get_symbol(x - 1, y)->glyph = ' ';
+    }
+    else if(glyphs[sym->glyph].width == 2 && x + 1 < vterm->width)
+    {
+        _term_get_symbol(x + 1, y)->glyph = ' ';
     }
 
-    if(symbol->ta_flags != new_ta_flags)
+    if(glyphs[glyph].width == 2)
     {
-        return true;
+        if(x + 1 >= vterm->width)
+        {
+            sym->glyph = ' ';
+            return;
+        }
+
+        struct VTermSymbol* next = _term_get_symbol(x + 1, y);
+        if(glyphs[next->glyph].width == 2 && x + 2 < vterm->width)
+        {
+            _term_get_symbol(x + 2, y)->glyph = ' ';
+        }
+
+        next->glyph = C_GLYPH_CONTINUATION;
     }
 
-    return false;
+    sym->glyph = glyph;
+}
+
+static void _vterm_create(void)
+{
+    _init_byte_strings();
+    _init_glyphs();
+
+    vterm = malloc(sizeof(struct VTerm));
+    if(!vterm)
+    {
+        abort();
+    }
+
+    memset(vterm, 0, sizeof(struct VTerm));
+    for(int i = 0; i < C_FRAME_COUNT; ++i)
+    {
+        vterm->frame_cursors[i].x = -1;
+        vterm->frame_cursors[i].visible = true;
+    }
+    vterm->front_cursor.x = -1;
+    vterm->front_cursor.visible = true;
+    vterm->write_frame = 0;
+    vterm->handoff_frame = 1;
+    vterm->read_frame = 2;
 }
 
 // EXTERNAL FUNCS
@@ -198,10 +1043,8 @@ void term_init(void)
 
     // Take control of the terminal
     setvbuf(stdout, NULL, _IONBF, 0);
-    write(1, C_ALT_BUFFER_ON, sizeof(C_ALT_BUFFER_ON));
-
-    vterm = malloc(sizeof(struct VTerm));
-    memset(vterm, 0, sizeof(struct VTerm));
+    _vterm_create();
+    WRITE_DIRECT_LITERAL(C_ALT_BUFFER_ON);
 
     struct termios t;
     tcgetattr(1, &t);
@@ -211,13 +1054,33 @@ void term_init(void)
     tcsetattr(1, TCSANOW, &t);
 
     term_resize();
-    term_clear();
     term_set_cursor(false);
-    write_buffer.buffer_len = 0;
 
     atexit(&term_uninit);
 }
 
+void term_init_headless(int width, int height, const char* path)
+{
+    if(vterm)
+    {
+        return;
+    }
+
+    _vterm_create();
+    vterm->headless = true;
+    vterm->width    = width;
+    vterm->height   = height;
+
+    if(path)
+    {
+        vterm->sink_file = fopen(path, "wb");
+    }
+
+    WRITE_DIRECT_LITERAL(C_ALT_BUFFER_ON);
+    term_resize();
+    term_set_cursor(false);
+}
+
 void term_uninit(void)
 {
     if(!vterm)
@@ -225,18 +1088,41 @@ void term_uninit(void)
         return;
     }
 
+    term_stop_render_thread();
     term_clear();
     term_set_cursor(true);
 
-    write(1, C_ALT_BUFFER_OFF, sizeof(C_ALT_BUFFER_OFF));
-    tcsetattr(1, TCSANOW, &vterm->initial_state);
+    WRITE_DIRECT_LITERAL(C_ALT_BUFFER_OFF);
+
+    if(vterm->headless)
+    {
+        if(vterm->sink_file)
+        {
+            fclose(vterm->sink_file);
+        }
+    }
+    else
+    {
+        tcsetattr(1, TCSANOW, &vterm->initial_state);
+    }
 
-    free(vterm->symbols);
+    free(vterm->front);
+    free(vterm->front_row_hashes);
+    free(vterm->frame_row_hashes);
+    for(int i = 0; i < C_FRAME_COUNT; ++i)
+    {
+        free(vterm->frames[i]);
+    }
     free(vterm);
 
     vterm = NULL;
 }
 
+void term_get_sink_stats(struct TermSinkStats* stats)
+{
+    *stats = vterm->sink_stats;
+}
+
 void term_get_wh(int* w, int* h)
 {
     if(w) *w = vterm->width;
@@ -245,15 +1131,23 @@ void term_get_wh(int* w, int* h)
 
 void term_set_cursor(bool on)
 {
-    vterm->cursor = on;
+    vterm->frame_cursors[vterm->write_frame].visible = on;
+
+    // The render thread shows or hides it with the next frame
+    if(vterm->render_thread_running)
+    {
+        return;
+    }
+
+    vterm->front_cursor.visible = on;
 
     if(on)
     {
-        write(1, C_CURSOR_ON, sizeof(C_CURSOR_ON));
+        WRITE_DIRECT_LITERAL(C_CURSOR_ON);
     }
     else
     {
-        write(1, C_CURSOR_OFF, sizeof(C_CURSOR_OFF));
+        WRITE_DIRECT_LITERAL(C_CURSOR_OFF);
     }
 }
 
@@ -278,168 +1172,195 @@ void term_set_sigint_callback(void(*handler)(int))
 
 void term_resize(void)
 {
-    struct winsize ws = { 0 };
-    ioctl(1, TIOCGWINSZ, &ws);
+    // Headless terminals keep the size they were created with
+    if(!vterm->headless)
+    {
+        struct winsize ws = { 0 };
+        ioctl(1, TIOCGWINSZ, &ws);
+
+        vterm->width  = ws.ws_col;
+        vterm->height = ws.ws_row;
+    }
 
-    vterm->width  = ws.ws_col;
-    vterm->height = ws.ws_row;
+    // The render thread cannot be reading the buffers while they move
+    bool restart_render_thread = vterm->render_thread_running;
+    term_stop_render_thread();
 
-    struct VTermSymbol* new_sym = realloc(vterm->symbols, vterm->width * vterm->height * sizeof(struct VTermSymbol));
-    if(!new_sym)
+    int count = vterm->width * vterm->height;
+    vterm->front = _realloc_symbols(vterm->front, count);
+    for(int i = 0; i < C_FRAME_COUNT; ++i)
     {
-        // Couldn't realloc the memory, which means something bad has happened.
-        // Cannot really continue from this situation so just die.
-        abort();
+        vterm->frames[i] = _realloc_symbols(vterm->frames[i], count);
     }
+    vterm->back = vterm->frames[vterm->write_frame];
 
-    memset(new_sym, 0, vterm->width * vterm->height * sizeof(struct VTermSymbol));
-    vterm->symbols = new_sym;
-}
+    vterm->front_row_hashes = _realloc_row_hashes(vterm->front_row_hashes, vterm->height);
+    vterm->frame_row_hashes = _realloc_row_hashes(vterm->frame_row_hashes, vterm->height);
+    vterm->blank_row_hash = _hash_row(vterm->front);
+    _hash_front_rows();
 
-void term_clear(void)
-{
-    memset(vterm->symbols, 0, vterm->width * vterm->height * sizeof(struct VTermSymbol));
-    _writef("%s", C_CLEAR);
-}
+    // The front buffer is blank, so make sure the terminal is too
+    WRITE_LITERAL(C_CLEAR);
 
-void term_clear_area(int x, int y, int w, int h)
-{
-    struct VTermSymbol* symbol;
-    for(int _y = y; _y < (y + h); ++_y)
-    for(int _x = x; _x < (x + w); ++_x)
+    if(restart_render_thread)
     {
-        symbol = _term_get_symbol(_x, _y);
-        symbol->symbol = ' ';
-        symbol->fg = C_DEFAULT_colour;
-        symbol->bg = C_DEFAULT_colour;
-        symbol->ta_flags = A_NONE;
-        symbol->redraw = true;
+        term_start_render_thread();
     }
 }
 
-void term_refresh(void)
+void term_start_render_thread(void)
 {
-    //TODO: See if batching is possible for fewer ANSI codes.
-    struct VTermSymbol* sym = NULL;
-    int lx = -1;
-    int ly = -1;
-
-    for(int y = 0; y < vterm->height; ++y)
-    for(int x = 0; x < vterm->width; ++x)
+    if(vterm->render_thread_running)
     {
-        sym = _term_get_symbol(x, y);
-
-        if(!sym->redraw)
-        {
-            continue;
-        }
+        return;
+    }
 
-        // Move to
-        if (x != lx + 1 || y != ly)
-        {
-            term_move_cursor(x, y);
-        }
+    atomic_fetch_and_explicit(&vterm->handoff_frame, ~C_FRAME_STOP_BIT, memory_order_release);
+    vterm->render_thread_running = true;
+    thrd_create(&vterm->render_thread, &_render_thread_update, NULL);
+}
 
-        lx = x;
-        ly = y;
+void term_stop_render_thread(void)
+{
+    if(!vterm->render_thread_running)
+    {
+        return;
+    }
 
-        // Start graphics mode
-        bool semicolon = false;
-        _writef(C_ESCAPE);
-        _writef(C_ESCAPE_KIND);
+    atomic_fetch_or_explicit(&vterm->handoff_frame, C_FRAME_STOP_BIT, memory_order_release);
+    futex_wake(&vterm->handoff_frame, 1);
+    thrd_join(vterm->render_thread, NULL);
 
-        // Set attributes
-        if(sym->ta_flags != A_NONE_BIT)
-        {
-            if(sym->ta_flags & A_BOLD_BIT)
-            {
-                _write_attribute(A_BOLD, semicolon);
-                semicolon = true;
-            }
+    vterm->render_thread_running = false;
+}
 
-            if(sym->ta_flags & A_UNDERSCORE_BIT)
-            {
-                _write_attribute(A_UNDERSCORE, semicolon);
-                semicolon = true;
-            }
+void term_set_colour_mode(enum TermColourMode mode)
+{
+    if(vterm->colour_mode == mode)
+    {
+        return;
+    }
 
-            if(sym->ta_flags & A_BLINK_BIT)
-            {
-                _write_attribute(A_BLINK, semicolon);
-                semicolon = true;
-            }
+    bool restart_render_thread = vterm->render_thread_running;
+    term_stop_render_thread();
 
-            if(sym->ta_flags & A_REVERSE_BIT)
-            {
-                _write_attribute(A_REVERSE, semicolon);
-                semicolon = true;
-            }
-        }
-        else
-        {
-            _write_attribute(A_NONE, semicolon);
-            semicolon = true;
-        }
+    if(mode != COLOUR_MODE_TRUE)
+    {
+        _build_colour_lut(mode);
+    }
+    vterm->colour_mode = mode;
 
-        // Set colours
-        _write_fg_colour(&sym->fg, semicolon);
-        _write_bg_colour(&sym->bg, semicolon);
+    // Flags with the unused bits set never match a drawn cell, so the next refresh repaints everything
+    memset(vterm->front, 0xFF, vterm->width * vterm->height * sizeof(struct VTermSymbol));
+    _hash_front_rows();
 
-        _writef(C_GRAPHICS_MODE);
+    if(restart_render_thread)
+    {
+        term_start_render_thread();
+    }
+}
 
-        // Write symbol
-        _writef("%c", sym->symbol);
-        _writef(C_DEFAULT);
+void term_clear(void)
+{
+    _clear_symbols(vterm->back, vterm->width * vterm->height);
+}
 
-        sym->redraw = false;
+void term_clear_area(int x, int y, int w, int h)
+{
+    for(int _y = y; _y < (y + h); ++_y)
+    for(int _x = x; _x < (x + w); ++_x)
+    {
+        _set_glyph(_x, _y, ' ');
+        *_term_get_symbol(_x, _y) = C_BLANK_SYMBOL;
     }
+}
 
-    // Reset term attributes
-    _writef(C_DEFAULT);
-    _flush();
+void term_refresh(void)
+{
+    if(vterm->render_thread_running)
+    {
+        _publish_frame();
+    }
+    else
+    {
+        _render_frame(vterm->write_frame);
+    }
 }
 
 void term_move_cursor(int x, int y)
 {
-    _writef(C_MOVE_FORMAT, y+1, x+1);
+    vterm->frame_cursors[vterm->write_frame].x = x;
+    vterm->frame_cursors[vterm->write_frame].y = y;
 }
 
 void term_set_attr(int x, int y, TextAttributeFlags ta_flags)
 {
     struct VTermSymbol* sym = _term_get_symbol(x, y);
-
-    if(!bit_flags_has_flags(sym->ta_flags, ta_flags))
-    {
-        bit_flags_set_flags(sym->ta_flags, ta_flags);
-        sym->redraw = true;
-    }
+    bit_flags_set_flags(sym->flags, (ta_flags & C_SYMBOL_ATTRIBUTE_MASK));
 }
 
 void term_unset_attr(int x, int y, TextAttributeFlags ta_flags)
 {
     struct VTermSymbol* sym = _term_get_symbol(x, y);
+    bit_flags_unset_flags(sym->flags, (ta_flags & C_SYMBOL_ATTRIBUTE_MASK));
+}
+
+int term_register_glyph(const char* utf8, int width)
+{
+    int length = strlen(utf8);
+    if(length == 0 || length > C_GLYPH_MAX_BYTES || width < 1 || width > 2)
+    {
+        return -1;
+    }
 
-    if(bit_flags_has_flags(sym->ta_flags, ta_flags))
+    for(int i = C_GLYPH_FIRST_REGISTERED; i < glyph_count; ++i)
     {
-        bit_flags_unset_flags(sym->ta_flags, ta_flags);
-        sym->redraw = true;
+        if(glyphs[i].length == length && memcmp(glyphs[i].bytes, utf8, length) == 0)
+        {
+            return i;
+        }
     }
+
+    if(glyph_count == C_GLYPH_COUNT)
+    {
+        return -1;
+    }
+
+    struct Glyph* glyph = &glyphs[glyph_count];
+    memcpy(glyph->bytes, utf8, length);
+    glyph->length = length;
+    glyph->width  = width;
+
+    return glyph_count++;
 }
 
 void term_draw_symbol(int x, int y, struct Colour* fg, struct Colour* bg, TextAttributeFlags ta_flags, char symbol)
+{
+    // Would otherwise be taken as the right half of a wide glyph
+    if(symbol == '\0')
+    {
+        symbol = ' ';
+    }
+
+    term_draw_glyph(x, y, fg, bg, ta_flags, (unsigned char)symbol);
+}
+
+void term_draw_glyph(int x, int y, struct Colour* fg, struct Colour* bg, TextAttributeFlags ta_flags, int glyph)
 {
     //if(!fg) fg = &C_DEFAULT_COLOUR;
     //if(!bg) bg = &C_DEFAULT_COLOUR;
 
-    struct VTermSymbol* sym = _term_get_symbol(x, y);
-    if(_should_redraw(sym, symbol, fg, bg, ta_flags))
+    if(glyph <= C_GLYPH_CONTINUATION || glyph >= C_GLYPH_COUNT)
     {
-        sym->symbol = symbol;
-        if(fg) sym->fg = *fg;
-        if(bg) sym->bg = *bg;
-        sym->ta_flags = ta_flags;
-        sym->redraw = true;
+        glyph = '?';
     }
+
+    struct VTermSymbol* sym = _term_get_symbol(x, y);
+    _set_glyph(x, y, glyph);
+
+    sym->flags = (sym->flags & ~C_SYMBOL_ATTRIBUTE_MASK) | (ta_flags & C_SYMBOL_ATTRIBUTE_MASK);
+    _set_symbol_colour(sym, sym->fg, C_SYMBOL_DEFAULT_FG_BIT, fg);
+    _set_symbol_colour(sym, sym->bg, C_SYMBOL_DEFAULT_BG_BIT, bg);
 }
 
 void term_draw_text(int x, int y, struct Colour* fg, struct Colour* bg, TextAttributeFlags ta_flags, const char* text)
@@ -63,11 +63,58 @@ static void _test_cache_add__resize(void* userstate)
     }
 }
 
+static void _setup_cache_paged(void* userstate)
+{
+    struct CacheTestState* state = userstate;
+    state->cache = cache_new_paged(sizeof(struct TestItem), 32, NULL, NULL);
+
+    for(int i = 0; i < TEST_ELEMENTS_MAX; ++i)
+    {
+        struct TestItem item;
+        item.i = 32 - i;
+        item.f = (float)i * 7.0f;
+        state->handles[i] = cache_add(state->cache, &item);
+    }
+}
+
+static void _test_cache_add__new_page(void* userstate)
+{
+    struct CacheTestState* state = userstate;
+
+    test_assert_equal_int("cache count equal capacity", cache_size(state->cache), cache_capacity(state->cache));
+
+    struct TestItem* first_item = cache_get(state->cache, state->handles[0]);
+    struct TestItem* last_item = cache_get(state->cache, state->handles[TEST_ELEMENTS_MAX - 1]);
+
+    struct TestItem t;
+    t.i = 0;
+    t.f = 32.0f * 7.0f;
+    int new_handle = cache_add(state->cache, &t);
+
+    test_assert_equal_int("cache new capacity", 64, cache_capacity(state->cache));
+    test_assert_equal_bool("first item not moved", true, first_item == cache_get(state->cache, state->handles[0]));
+    test_assert_equal_bool("last item not moved", true, last_item == cache_get(state->cache, state->handles[TEST_ELEMENTS_MAX - 1]));
+
+    struct TestItem* new_item = cache_get(state->cache, new_handle);
+    test_assert_not_null("new item", new_item);
+    test_assert_equal_int("new item int value", 0, new_item->i);
+
+    int i = 0;
+    for(struct CacheIt it = cache_begin(state->cache); !cache_it_eq(it, cache_end(state->cache)); it = cache_it_next(it))
+    {
+        struct TestItem* item = cache_it_get(it);
+        test_assert_equal_int("elem int value", 32 - i, item->i);
+        test_assert_equal_float("elem float value", (float)i * 7.0f, item->f);
+        ++i;
+    }
+}
+
 void test_cache_add(void)
 {
     struct CacheTestState userstate;
     testing_add_group("cache add");
     testing_add_test("add with resize", &_setup_cache, &_teardown_cache, &_test_cache_add__resize, &userstate, sizeof(struct CacheTestState));
+    testing_add_test("add with new page", &_setup_cache_paged, &_teardown_cache, &_test_cache_add__new_page, &userstate, sizeof(struct CacheTestState));
 }
 
 static void _test_cache_iterator__cache_no_gaps([[maybe_unused]] void* userstate)
@@ -123,6 +170,93 @@ static void _test_cache_iterator__no_valid_items__items_removed([[maybe_unused]]
     test_assert_equal_int("iterator index", 0, i);
 }
 
+static void _test_cache_iterator__sparse_cache([[maybe_unused]] void* userstate)
+{
+    const int C_ITEMS_MAX = 300;
+    const int C_KEEP_IDX[] = { 0, 70, 191, 299 };
+
+    struct Cache* cache = cache_new(sizeof(struct TestItem), C_ITEMS_MAX, NULL, NULL);
+    int handles[C_ITEMS_MAX];
+
+    for(int i = 0; i < C_ITEMS_MAX; ++i)
+    {
+        struct TestItem item;
+        item.i = i;
+        item.f = 0.0f;
+        handles[i] = cache_add(cache, &item);
+    }
+
+    for(int i = 0; i < C_ITEMS_MAX; ++i)
+    {
+        if(i != C_KEEP_IDX[0] && i != C_KEEP_IDX[1] && i != C_KEEP_IDX[2] && i != C_KEEP_IDX[3])
+        {
+            cache_remove(cache, handles[i]);
+        }
+    }
+
+    int count = 0;
+    for(struct CacheIt it = cache_begin(cache); !cache_it_eq(it, cache_end(cache)); it = cache_it_next(it))
+    {
+        struct TestItem* item = cache_it_get(it);
+        if(count < 4)
+        {
+            test_assert_equal_int("elem int value", C_KEEP_IDX[count], item->i);
+        }
+        ++count;
+    }
+
+    test_assert_equal_int("iterated count", 4, count);
+
+    cache_free(cache);
+}
+
+static void _test_cache_free_policy(void* userstate, enum CacheFreePolicy free_policy, const int expect[3])
+{
+    struct CacheTestState* state = userstate;
+    const int C_REMOVE_IDX[] = { 3, 20, 5 };
+
+    cache_set_free_policy(state->cache, free_policy);
+
+    for(int i = 0; i < 3; ++i)
+    {
+        cache_remove(state->cache, state->handles[C_REMOVE_IDX[i]]);
+    }
+
+    for(int i = 0; i < 3; ++i)
+    {
+        struct TestItem item;
+        item.i = 100 + i;
+        item.f = 0.0f;
+        cache_add(state->cache, &item);
+    }
+
+    test_assert_equal_int("cache used", TEST_ELEMENTS_MAX, cache_used(state->cache));
+
+    int i = 0;
+    for(struct CacheIt it = cache_begin(state->cache); !cache_it_eq(it, cache_end(state->cache)); it = cache_it_next(it))
+    {
+        struct TestItem* item = cache_it_get(it);
+        if(i == 3 || i == 5 || i == 20)
+        {
+            int expect_idx = i == 3 ? 0 : (i == 5 ? 1 : 2);
+            test_assert_equal_int("reused elem int value", expect[expect_idx], item->i);
+        }
+        ++i;
+    }
+}
+
+static void _test_cache_iterator__free_policy_lifo(void* userstate)
+{
+    const int C_EXPECT[] = { 102, 100, 101 };
+    _test_cache_free_policy(userstate, CACHE_FREE_POLICY_LIFO, C_EXPECT);
+}
+
+static void _test_cache_iterator__free_policy_lowest_first(void* userstate)
+{
+    const int C_EXPECT[] = { 100, 101, 102 };
+    _test_cache_free_policy(userstate, CACHE_FREE_POLICY_LOWEST_FIRST, C_EXPECT);
+}
+
 void test_cache_iterator(void)
 {
     struct CacheTestState userstate;
@@ -131,6 +265,9 @@ void test_cache_iterator(void)
     testing_add_test("cache iterator, no gaps", &_setup_cache, &_teardown_cache, &_test_cache_iterator__cache_no_gaps, &userstate, sizeof(struct CacheTestState));
     testing_add_test("cache iterator, cache with gaps", &_setup_cache, &_teardown_cache, &_test_cache_iterator__cache_with_gaps, &userstate, sizeof(struct CacheTestState));
     testing_add_test("cache iterator, no valid elements, items removed", &_setup_cache, &_teardown_cache, &_test_cache_iterator__no_valid_items__items_removed, &userstate, sizeof(struct CacheTestState));
+    testing_add_test("cache iterator, sparse cache", NULL, NULL, &_test_cache_iterator__sparse_cache, NULL, 0);
+    testing_add_test("cache iterator, reused slots, lifo free policy", &_setup_cache, &_teardown_cache, &_test_cache_iterator__free_policy_lifo, &userstate, sizeof(struct CacheTestState));
+    testing_add_test("cache iterator, reused slots, lowest first free policy", &_setup_cache, &_teardown_cache, &_test_cache_iterator__free_policy_lowest_first, &userstate, sizeof(struct CacheTestState));
 }
 
 
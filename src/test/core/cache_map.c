@@ -2,8 +2,11 @@
 #include "scieppend/test/test.h"
 
 #include "scieppend/core/cache_map.h"
+#include "scieppend/core/cache_map_threadsafe.h"
 
 #include <stddef.h>
+#include <stdatomic.h>
+#include <threads.h>
 
 struct CacheMapTestItem
 {
@@ -72,6 +75,107 @@ static void _test_cache_map__add__without_resize(void* userdata)
 
 static void _test_cache_map__add__with_resize(void* userdata)
 {
+    const int C_ITEMS_SIZE = 1000;
+
+    struct CacheMapTestState* state = userdata;
+
+    for(int i = 0; i < C_ITEMS_SIZE; ++i)
+    {
+        struct CacheMapTestItem item = { i, (float)i * 7.0f };
+        cache_map_add(&state->map, &item.i, sizeof(int), &item);
+    }
+
+    test_assert_equal_int("count", C_ITEMS_SIZE, cache_map_count(&state->map));
+
+    int found_count = 0;
+    for(int i = 0; i < C_ITEMS_SIZE; ++i)
+    {
+        const struct CacheMapTestItem* actual_item = cache_map_get(&state->map, &i, sizeof(int));
+        if(actual_item && actual_item->i == i && actual_item->f == (float)i * 7.0f)
+        {
+            ++found_count;
+        }
+    }
+
+    test_assert_equal_int("found count", C_ITEMS_SIZE, found_count);
+}
+
+static void _test_cache_map__add__during_migration(void* userdata)
+{
+    struct CacheMapTestState* state = userdata;
+
+    // Fill until the table has grown and is still migrating from the old one
+    int added = 0;
+    while(state->map.old_table.slot_count == 0)
+    {
+        struct CacheMapTestItem item = { added, (float)added };
+        cache_map_add(&state->map, &item.i, sizeof(int), &item);
+        ++added;
+    }
+
+    test_assert_equal_bool("old table kept", true, state->map.old_table.slot_count > 0);
+
+    int found_count = 0;
+    for(int i = 0; i < added; ++i)
+    {
+        const struct CacheMapTestItem* actual_item = cache_map_get(&state->map, &i, sizeof(int));
+        if(actual_item && actual_item->i == i)
+        {
+            ++found_count;
+        }
+    }
+
+    test_assert_equal_int("found count while migrating", added, found_count);
+
+    int it_count = 0;
+    struct It it = cache_map_begin(&state->map);
+    struct It end = cache_map_end(&state->map);
+    for(; !it_eq(&it, &end); cache_map_it_next(&it))
+    {
+        ++it_count;
+    }
+
+    test_assert_equal_int("iterated count while migrating", added, it_count);
+
+    // Remove every other item, some of which are still in the old table
+    for(int i = 0; i < added; i += 2)
+    {
+        cache_map_remove(&state->map, &i, sizeof(int));
+    }
+
+    for(int i = 0; i < added; ++i)
+    {
+        const struct CacheMapTestItem* actual_item = cache_map_get(&state->map, &i, sizeof(int));
+        test_assert_equal_bool("item found", (i % 2) == 1, actual_item != NULL);
+    }
+
+    test_assert_equal_int("old table freed", 0, state->map.old_table.slot_count);
+    test_assert_equal_int("count", added / 2, cache_map_count(&state->map));
+}
+
+static void _test_cache_map__add__colliding_hashes(void* userdata)
+{
+    const unsigned long long C_FORCED_HASH = 0x1234;
+    const char* C_SHORT_KEY = "short";
+    const char* C_LONG_KEY = "a key that is too long to be stored inline";
+
+    struct CacheMapTestState* state = userdata;
+
+    struct CacheMapTestItem* short_item = cache_map_emplace_with_hash(&state->map, C_SHORT_KEY, 5, C_FORCED_HASH, NULL);
+    short_item->i = 1;
+    struct CacheMapTestItem* long_item = cache_map_emplace_with_hash(&state->map, C_LONG_KEY, 42, C_FORCED_HASH, NULL);
+    long_item->i = 2;
+
+    test_assert_equal_int("count", 2, cache_map_count(&state->map));
+
+    const struct CacheMapTestItem* actual_short = cache_map_get_with_hash(&state->map, C_SHORT_KEY, 5, C_FORCED_HASH);
+    const struct CacheMapTestItem* actual_long = cache_map_get_with_hash(&state->map, C_LONG_KEY, 42, C_FORCED_HASH);
+
+    test_assert_not_null("short key item", actual_short);
+    test_assert_not_null("long key item", actual_long);
+    test_assert_equal_int("short key item i", 1, actual_short ? actual_short->i : -1);
+    test_assert_equal_int("long key item i", 2, actual_long ? actual_long->i : -1);
+    test_assert_null("different key, same hash", cache_map_get_with_hash(&state->map, "other", 5, C_FORCED_HASH));
 }
 
 void test_cache_map_add(void)
@@ -79,7 +183,9 @@ void test_cache_map_add(void)
     struct CacheMapTestState state;
     testing_add_group("CacheMap::add");
     testing_add_test("without resize", &_setup, &_teardown, &_test_cache_map__add__without_resize, &state, sizeof(state));
-    //testing_add_test("with resize", &_setup, &_teardown, &_test_cache_map__add__with_resize, &state, sizeof(state));
+    testing_add_test("with resize", &_setup, &_teardown, &_test_cache_map__add__with_resize, &state, sizeof(state));
+    testing_add_test("during migration", &_setup, &_teardown, &_test_cache_map__add__during_migration, &state, sizeof(state));
+    testing_add_test("colliding hashes", &_setup, &_teardown, &_test_cache_map__add__colliding_hashes, &state, sizeof(state));
 }
 
 static void _test_cache_map__remove__without_resize(void* userdata)
@@ -116,17 +222,138 @@ static void _test_cache_map__remove__without_resize(void* userdata)
     }
 }
 
+static void _test_cache_map__remove__churn(void* userdata)
+{
+    const int C_ITEMS_SIZE = 24;
+    const int C_ROUNDS = 200;
+
+    struct CacheMapTestState* state = userdata;
+
+    // Keep a small live set while adding and removing many distinct keys, so the table fills with tombstones
+    for(int round = 0; round < C_ROUNDS; ++round)
+    {
+        for(int i = 0; i < C_ITEMS_SIZE; ++i)
+        {
+            struct CacheMapTestItem item = { (round * C_ITEMS_SIZE) + i, (float)round };
+            cache_map_add(&state->map, &item.i, sizeof(int), &item);
+        }
+
+        for(int i = 0; i < C_ITEMS_SIZE; ++i)
+        {
+            int key = (round * C_ITEMS_SIZE) + i;
+            cache_map_remove(&state->map, &key, sizeof(int));
+        }
+    }
+
+    test_assert_equal_int("count", 0, cache_map_count(&state->map));
+
+    struct CacheMapTestItem item = { -7, 1.0f };
+    cache_map_add(&state->map, &item.i, sizeof(int), &item);
+
+    const struct CacheMapTestItem* actual_item = cache_map_get(&state->map, &item.i, sizeof(int));
+    test_assert_not_null("item after churn", actual_item);
+    test_assert_equal_int("count", 1, cache_map_count(&state->map));
+}
+
 void test_cache_map_remove(void)
 {
     struct CacheMapTestState state;
     testing_add_group("CacheMap::remove");
     testing_add_test("without resize", &_setup, &_teardown, &_test_cache_map__remove__without_resize, &state, sizeof(state));
     //testing_add_test("with resize", &_setup, &_teardown, &_test_cache_map__remove__with_resize, &state, sizeof(state));
+    testing_add_test("churn", &_setup, &_teardown, &_test_cache_map__remove__churn, &state, sizeof(state));
+}
+
+// THREADSAFE
+
+struct CacheMapTSTestState
+{
+    struct CacheMap_ThreadSafe map;
+    atomic_bool                writer_done;
+    atomic_int                 reader_misses;
+};
+
+static void _setup_ts(void* userdata)
+{
+    struct CacheMapTSTestState* state = userdata;
+    cache_map_ts_init(&state->map, sizeof(struct CacheMapTestItem), 4, NULL, NULL);
+    atomic_init(&state->writer_done, false);
+    atomic_init(&state->reader_misses, 0);
+}
+
+static void _teardown_ts(void* userdata)
+{
+    struct CacheMapTSTestState* state = userdata;
+    cache_map_ts_uninit(&state->map);
+}
+
+static int _cache_map_ts_reader(void* userdata)
+{
+    struct CacheMapTSTestState* state = userdata;
+
+    // Key 0 is added before the threads start and is never removed, so it must always be found
+    // while the writer forces the table to resize underneath
+    while(!atomic_load(&state->writer_done))
+    {
+        int key = 0;
+        const struct CacheMapTestItem* item = cache_map_ts_get(&state->map, &key, sizeof(int));
+        if(item == NULL || item->i != 0)
+        {
+            atomic_fetch_add(&state->reader_misses, 1);
+        }
+    }
+
+    return 0;
+}
+
+static void _test_cache_map__threadsafe__concurrent_readers(void* userstate)
+{
+    struct CacheMapTSTestState* state = userstate;
+    const int C_ITEMS_SIZE = 2000;
+    const int C_READERS = 4;
+
+    struct CacheMapTestItem first = { 0, 0.0f };
+    cache_map_ts_add(&state->map, &first.i, sizeof(int), &first);
+
+    thrd_t readers[C_READERS];
+    for(int i = 0; i < C_READERS; ++i)
+    {
+        thrd_create(&readers[i], &_cache_map_ts_reader, state);
+    }
+
+    for(int i = 1; i < C_ITEMS_SIZE; ++i)
+    {
+        struct CacheMapTestItem item = { i, (float)i };
+        cache_map_ts_add(&state->map, &item.i, sizeof(int), &item);
+    }
+
+    atomic_store(&state->writer_done, true);
+    for(int i = 0; i < C_READERS; ++i)
+    {
+        thrd_join(readers[i], NULL);
+    }
+
+    test_assert_equal_int("reader misses", 0, atomic_load(&state->reader_misses));
+    test_assert_equal_int("count", C_ITEMS_SIZE, cache_map_ts_count(&state->map));
+
+    for(int i = 0; i < C_ITEMS_SIZE; ++i)
+    {
+        const struct CacheMapTestItem* item = cache_map_ts_get(&state->map, &i, sizeof(int));
+        test_assert_not_null("item", item);
+    }
+}
+
+void test_cache_map_threadsafe(void)
+{
+    struct CacheMapTSTestState state;
+    testing_add_group("CacheMap_ThreadSafe");
+    testing_add_test("concurrent readers", &_setup_ts, &_teardown_ts, &_test_cache_map__threadsafe__concurrent_readers, &state, sizeof(state));
 }
 
 void test_cache_map_run_all(void)
 {
     test_cache_map_add();
     test_cache_map_remove();
+    test_cache_map_threadsafe();
 }
 
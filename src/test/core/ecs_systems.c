@@ -1,5 +1,8 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "scieppend/test/core/ecs.h"
 
+#include "scieppend/core/ecs_recorder.h"
 #include "scieppend/core/ecs_world.h"
 #include "scieppend/core/event.h"
 #include "scieppend/core/string.h"
@@ -7,6 +10,10 @@
 #include "scieppend/test/core/ecs_common.h"
 #include "scieppend/test/test.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
 struct SystemTestState
 {
     struct ECSWorld* world;
@@ -29,18 +36,13 @@ static void _system_update(struct ECSWorld* world, EntityHandle entity_handle)
     ecs_world_entity_unget_component(world, entity_handle, COMPONENT_TYPE_ID(ECSTestComponentA), WRITE);
 }
 
-static void _setup(void* userstate)
+static struct ECSWorld* _create_world(void)
 {
-    ecs_common_init();
-    eventing_init();
-
-    struct SystemTestState* state = userstate;
+    struct ECSWorld* world = ecs_world_new();
 
-    state->world = ecs_world_new();
-
-    ecs_world_component_type_register(state->world, COMPONENT_TYPE_ID(ECSTestComponentA), sizeof(struct ECSTestComponentA));
-    ecs_world_component_type_register(state->world, COMPONENT_TYPE_ID(ECSTestComponentB), sizeof(struct ECSTestComponentB));
-    ecs_world_component_type_register(state->world, COMPONENT_TYPE_ID(ECSTestComponentC), sizeof(struct ECSTestComponentC));
+    ecs_world_component_type_register(world, COMPONENT_TYPE_ID(ECSTestComponentA), sizeof(struct ECSTestComponentA));
+    ecs_world_component_type_register(world, COMPONENT_TYPE_ID(ECSTestComponentB), sizeof(struct ECSTestComponentB));
+    ecs_world_component_type_register(world, COMPONENT_TYPE_ID(ECSTestComponentC), sizeof(struct ECSTestComponentC));
 
     struct Array required_components;
     array_init(&required_components, sizeof(ComponentTypeHandle), 3, NULL, NULL);
@@ -51,10 +53,21 @@ static void _setup(void* userstate)
     struct string system_name;
     string_init(&system_name, "TestSystemName");
 
-    ecs_world_system_register(state->world, &system_name, &required_components, &_system_update);
+    ecs_world_system_register(world, &system_name, &required_components, &_system_update);
 
     string_uninit(&system_name);
     array_uninit(&required_components);
+
+    return world;
+}
+
+static void _setup(void* userstate)
+{
+    ecs_common_init();
+    eventing_init();
+
+    struct SystemTestState* state = userstate;
+    state->world = _create_world();
 }
 
 static void _teardown(void* userstate)
@@ -80,6 +93,25 @@ void _test__system_uniqueness(void* userstate)
     test_assert_equal_int("systems registered count", 1, ecs_world_systems_count(state->world));
 }
 
+void _test__system_lookup_by_id(void* userstate)
+{
+    struct SystemTestState* state = userstate;
+
+    struct string system_name;
+    string_init(&system_name, "TestSystemName");
+    struct System* system = ecs_world_get_system(state->world, &system_name);
+    int name_id = string_intern_find(&system_name);
+
+    test_assert_not_null("system by name", system);
+    test_assert_equal_bool("same system by id", true, system == ecs_world_get_system_by_id(state->world, name_id));
+
+    string_set(&system_name, "UnregisteredSystemName");
+    test_assert_null("unregistered system by name", ecs_world_get_system(state->world, &system_name));
+    test_assert_null("unregistered system by id", ecs_world_get_system_by_id(state->world, string_intern(&system_name)));
+
+    string_uninit(&system_name);
+}
+
 void _test__system_entity_required_components_added(void* userstate)
 {
     struct SystemTestState* state = userstate;
@@ -153,12 +185,68 @@ void _test__system_update(void* userstate)
     ecs_world_destroy_entity(state->world, entity_handle);
 }
 
+void _test__system_record_and_replay(void* userstate)
+{
+    struct SystemTestState* state = userstate;
+    char recording_path[] = "/tmp/ecs_replay_test_XXXXXX";
+    int fd = mkstemp(recording_path);
+    test_assert_equal_bool("temp file created", true, fd != -1);
+    if(fd == -1)
+    {
+        return;
+    }
+    close(fd);
+
+    test_assert_equal_bool("recording started", true, ecs_recorder_start(recording_path));
+
+    EntityHandle entity_handles[4];
+    for(int i = 0; i < 4; ++i)
+    {
+        entity_handles[i] = ecs_world_create_entity(state->world);
+        ecs_world_entity_add_component(state->world, entity_handles[i], COMPONENT_TYPE_ID(ECSTestComponentA));
+        ecs_world_entity_add_component(state->world, entity_handles[i], COMPONENT_TYPE_ID(ECSTestComponentB));
+        ecs_world_entity_add_component(state->world, entity_handles[i], COMPONENT_TYPE_ID(ECSTestComponentC));
+    }
+
+    ecs_world_update_systems(state->world);
+    ecs_world_entity_remove_component(state->world, entity_handles[1], COMPONENT_TYPE_ID(ECSTestComponentB));
+    ecs_world_destroy_entity(state->world, entity_handles[2]);
+    ecs_world_update_systems(state->world);
+
+    // Replaying would record into the recording in progress
+    struct ECSWorld* replay_world = _create_world();
+    test_assert_equal_int("replay while recording", -1, ecs_replay(replay_world, recording_path));
+
+    ecs_recorder_stop();
+    test_assert_equal_bool("recording stopped", false, ecs_recorder_is_recording());
+
+    // 4 creates, 12 adds, 1 remove, 1 destroy and 2 updates
+    test_assert_equal_int("records replayed", 20, ecs_replay(replay_world, recording_path));
+
+    struct string system_name;
+    string_init(&system_name, "TestSystemName");
+    test_assert_equal_int("entities", ecs_world_entities_count(state->world), ecs_world_entities_count(replay_world));
+    test_assert_equal_int("system entities", ecs_world_system_entities_count(state->world, &system_name), ecs_world_system_entities_count(replay_world, &system_name));
+    test_assert_equal_int("component B count", ecs_world_components_count(state->world, COMPONENT_TYPE_ID(ECSTestComponentB)), ecs_world_components_count(replay_world, COMPONENT_TYPE_ID(ECSTestComponentB)));
+    string_uninit(&system_name);
+
+    ecs_world_free(replay_world);
+    remove(recording_path);
+
+    for(int i = 0; i < 4; ++i)
+    {
+        ecs_world_destroy_entity(state->world, entity_handles[i]);
+    }
+}
+
 void test_ecs_systems(void)
 {
     struct SystemTestState state;
     testing_add_group("system");
     testing_add_test("system uniqueness", &_setup, &_teardown, &_test__system_uniqueness, &state, sizeof(state));
+    testing_add_test("system lookup by id", &_setup, &_teardown, &_test__system_lookup_by_id, &state, sizeof(state));
     testing_add_test("system entity required components added", &_setup, &_teardown, &_test__system_entity_required_components_added, &state, sizeof(state));
     testing_add_test("system entity destroyed", &_setup, &_teardown, &_test__system_entity_destroyed, &state, sizeof(state));
     testing_add_test("system update", &_setup, &_teardown, &_test__system_update, &state, sizeof(state));
+    testing_add_test("system record and replay", &_setup, &_teardown, &_test__system_record_and_replay, &state, sizeof(state));
 }
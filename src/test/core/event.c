@@ -3,9 +3,16 @@
 #include "scieppend/core/array.h"
 #include "scieppend/core/container_common.h"
 #include "scieppend/core/event.h"
+#include "scieppend/core/event_channel.h"
 #include "scieppend/test/test.h"
 
+#include <stdatomic.h>
 #include <stddef.h>
+#include <threads.h>
+
+#define C_EVENT_TEST_CONCURRENT_OBSERVERS 4
+#define C_EVENT_TEST_CONCURRENT_CHANGES 2000
+#define C_EVENT_TEST_OBSERVER_MAGIC 0x0b5e7e
 
 struct EventTestState
 {
@@ -96,11 +103,40 @@ static void _test_event_register_and_deregister_observer(void* userstate)
     observer_destroy(obs);
 }
 
+static void _counting_callback([[maybe_unused]] const struct Event* sender, [[maybe_unused]] void* data, void* event_args)
+{
+    int* counter = event_args;
+    ++(*counter);
+}
+
+static void _test_event_destroyed_observer_skipped(void* userstate)
+{
+    struct EventTestState* state = userstate;
+
+    ObserverHandle destroyed_obs = observer_create(NULL, NULL);
+    event_register_observer(&state->event, destroyed_obs);
+    observer_destroy(destroyed_obs);
+
+    // Republishing the list drops the destroyed observer rather than calling it
+    ObserverHandle obs = observer_create(NULL, &_counting_callback);
+    event_register_observer(&state->event, obs);
+    test_assert_equal_int("event observer count", 1, event_observer_count(&state->event));
+
+    int counter = 0;
+    event_send(&state->event, &counter);
+    test_assert_equal_int("event received count", 1, counter);
+
+    event_deregister_observer(&state->event, obs);
+    event_deregister_observer(&state->event, destroyed_obs);
+    observer_destroy(obs);
+}
+
 void test_event_register_deregister(void)
 {
     struct EventTestState state;
     testing_add_group("register observer");
     testing_add_test("event register and deregister", &_setup, &_teardown, &_test_event_register_and_deregister_observer, &state, sizeof(state));
+    testing_add_test("destroyed observer skipped", &_setup, &_teardown, &_test_event_destroyed_observer_skipped, &state, sizeof(state));
 }
 
 void _setup_send(void* userstate)
@@ -152,8 +188,302 @@ void test_event_send(void)
     testing_add_test("event send", &_setup_send, &_teardown_send, &_test_event_send, &state, sizeof(state));
 }
 
+struct QueuedEventTestState
+{
+    struct Event event;
+    int          item_sum;
+    int          item_calls;
+    int          batch_sum;
+    int          batch_calls;
+    int          batch_count;
+};
+
+static void _queued_item_callback([[maybe_unused]] const struct Event* sender, void* data, void* event_args)
+{
+    struct QueuedEventTestState* state = data;
+    state->item_sum += *(int*)event_args;
+    ++state->item_calls;
+}
+
+static void _queued_batch_callback([[maybe_unused]] const struct Event* sender, void* data, void* event_args, int count, int args_size)
+{
+    struct QueuedEventTestState* state = data;
+    test_assert_equal_int("args size", sizeof(int), args_size);
+
+    const int* args = event_args;
+    for(int i = 0; i < count; ++i)
+    {
+        state->batch_sum += args[i];
+    }
+
+    state->batch_count += count;
+    ++state->batch_calls;
+}
+
+static void _setup_queued(void* userstate)
+{
+    struct QueuedEventTestState* state = userstate;
+    eventing_init();
+    event_init_queued(&state->event, sizeof(int), 4);
+    state->item_sum = 0;
+    state->item_calls = 0;
+    state->batch_sum = 0;
+    state->batch_calls = 0;
+    state->batch_count = 0;
+}
+
+static void _teardown_queued(void* userstate)
+{
+    struct QueuedEventTestState* state = userstate;
+    event_uninit(&state->event);
+    eventing_uninit();
+}
+
+static void _test_event_send_queued(void* userstate)
+{
+    struct QueuedEventTestState* state = userstate;
+    const int C_EVENTS_SIZE = 10;
+
+    ObserverHandle item_obs = observer_create(state, &_queued_item_callback);
+    ObserverHandle batch_obs = observer_create_batched(state, NULL, &_queued_batch_callback);
+    event_register_observer(&state->event, item_obs);
+    event_register_observer(&state->event, batch_obs);
+
+    // Sends past the initial ring capacity so it has to grow
+    int expect_sum = 0;
+    for(int i = 1; i <= C_EVENTS_SIZE; ++i)
+    {
+        event_send(&state->event, &i);
+        expect_sum += i;
+    }
+
+    test_assert_equal_int("queued count", C_EVENTS_SIZE, event_queued_count(&state->event));
+    test_assert_equal_int("no item calls before flush", 0, state->item_calls);
+    test_assert_equal_int("no batch calls before flush", 0, state->batch_calls);
+
+    event_flush(&state->event);
+
+    test_assert_equal_int("queued count after flush", 0, event_queued_count(&state->event));
+    test_assert_equal_int("item calls", C_EVENTS_SIZE, state->item_calls);
+    test_assert_equal_int("item sum", expect_sum, state->item_sum);
+    test_assert_equal_int("batch calls", 1, state->batch_calls);
+    test_assert_equal_int("batch count", C_EVENTS_SIZE, state->batch_count);
+    test_assert_equal_int("batch sum", expect_sum, state->batch_sum);
+
+    event_flush(&state->event);
+    test_assert_equal_int("empty flush calls nothing", 1, state->batch_calls);
+
+    event_deregister_observer(&state->event, batch_obs);
+    event_deregister_observer(&state->event, item_obs);
+    observer_destroy(batch_obs);
+    observer_destroy(item_obs);
+}
+
+static void _immediate_batch_callback([[maybe_unused]] const struct Event* sender, void* data, void* event_args, int count, int args_size)
+{
+    struct QueuedEventTestState* state = data;
+    test_assert_equal_int("immediate args size", 0, args_size);
+
+    state->batch_sum += *(int*)event_args;
+    state->batch_count += count;
+    ++state->batch_calls;
+}
+
+static void _test_event_send_batch_observer_immediate(void* userstate)
+{
+    struct QueuedEventTestState* state = userstate;
+
+    // Replace the queued event from setup with an immediate one
+    event_uninit(&state->event);
+    event_init(&state->event);
+
+    ObserverHandle batch_obs = observer_create_batched(state, NULL, &_immediate_batch_callback);
+    event_register_observer(&state->event, batch_obs);
+
+    for(int i = 1; i <= 3; ++i)
+    {
+        event_send(&state->event, &i);
+    }
+
+    test_assert_equal_int("batch calls", 3, state->batch_calls);
+    test_assert_equal_int("batch count", 3, state->batch_count);
+    test_assert_equal_int("batch sum", 6, state->batch_sum);
+
+    event_deregister_observer(&state->event, batch_obs);
+    observer_destroy(batch_obs);
+}
+
+struct ConcurrentEventTestState
+{
+    struct Event event;
+    atomic_bool  sending;
+    atomic_int   sends;
+    atomic_int   calls;
+    atomic_int   bad_calls;
+    int          magic[C_EVENT_TEST_CONCURRENT_OBSERVERS];
+};
+
+static void _concurrent_callback([[maybe_unused]] const struct Event* sender, void* data, void* event_args)
+{
+    struct ConcurrentEventTestState* state = event_args;
+    const int* magic = data;
+
+    // Only observers that were registered are ever called, and none have been destroyed yet
+    if(magic < state->magic || magic >= state->magic + C_EVENT_TEST_CONCURRENT_OBSERVERS || *magic != C_EVENT_TEST_OBSERVER_MAGIC)
+    {
+        atomic_fetch_add(&state->bad_calls, 1);
+    }
+
+    atomic_fetch_add(&state->calls, 1);
+}
+
+static int _concurrent_sender(void* userstate)
+{
+    struct ConcurrentEventTestState* state = userstate;
+    while(atomic_load(&state->sending))
+    {
+        event_send(&state->event, state);
+        atomic_fetch_add(&state->sends, 1);
+    }
+
+    return 0;
+}
+
+static void _test_event_send_concurrent_register(void* userstate)
+{
+    struct ConcurrentEventTestState* state = userstate;
+
+    eventing_init();
+    event_init(&state->event);
+    atomic_init(&state->sending, true);
+    atomic_init(&state->sends, 0);
+    atomic_init(&state->calls, 0);
+    atomic_init(&state->bad_calls, 0);
+
+    ObserverHandle observers[C_EVENT_TEST_CONCURRENT_OBSERVERS];
+    for(int i = 0; i < C_EVENT_TEST_CONCURRENT_OBSERVERS; ++i)
+    {
+        state->magic[i] = C_EVENT_TEST_OBSERVER_MAGIC;
+        observers[i] = observer_create(&state->magic[i], &_concurrent_callback);
+    }
+
+    thrd_t sender;
+    thrd_create(&sender, &_concurrent_sender, state);
+
+    // Make sure the changes overlap with sending
+    while(atomic_load(&state->sends) == 0)
+    {
+        thrd_yield();
+    }
+
+    for(int i = 0; i < C_EVENT_TEST_CONCURRENT_CHANGES; ++i)
+    {
+        // Register every observer, then deregister them all, and so on
+        ObserverHandle obs = observers[i % C_EVENT_TEST_CONCURRENT_OBSERVERS];
+        if((i / C_EVENT_TEST_CONCURRENT_OBSERVERS) % 2 == 0)
+        {
+            event_register_observer(&state->event, obs);
+        }
+        else
+        {
+            event_deregister_observer(&state->event, obs);
+        }
+    }
+
+    // Every phase above ends deregistered, so leave one registered until the sender has called it
+    event_register_observer(&state->event, observers[0]);
+    while(atomic_load(&state->calls) == 0)
+    {
+        thrd_yield();
+    }
+
+    atomic_store(&state->sending, false);
+    thrd_join(sender, NULL);
+
+    test_assert_equal_int("no calls to unregistered observers", 0, atomic_load(&state->bad_calls));
+    test_assert_equal_bool("observers called", true, atomic_load(&state->calls) > 0);
+    test_assert_not_null("lists retired while sending", state->event.retired_lists);
+
+    for(int i = 0; i < C_EVENT_TEST_CONCURRENT_OBSERVERS; ++i)
+    {
+        event_deregister_observer(&state->event, observers[i]);
+        observer_destroy(observers[i]);
+    }
+
+    event_uninit(&state->event);
+    test_assert_null("retired lists freed", state->event.retired_lists);
+
+    eventing_uninit();
+}
+
+void test_event_send_queued(void)
+{
+    struct QueuedEventTestState state;
+    testing_add_group("send queued");
+    testing_add_test("event send queued", &_setup_queued, &_teardown_queued, &_test_event_send_queued, &state, sizeof(state));
+    testing_add_test("batch observer on immediate event", &_setup_queued, &_teardown_queued, &_test_event_send_batch_observer_immediate, &state, sizeof(state));
+}
+
+void test_event_send_concurrent(void)
+{
+    struct ConcurrentEventTestState state;
+    testing_add_group("send concurrent");
+    testing_add_test("send while registering", NULL, NULL, &_test_event_send_concurrent_register, &state, sizeof(state));
+}
+
+struct ChannelTestArgs
+{
+    int a;
+    int b;
+};
+
+EVENT_CHANNEL_DECL(ChannelTest, struct ChannelTestArgs);
+
+static void _channel_test_callback([[maybe_unused]] const struct Event* sender, void* data, const struct ChannelTestArgs* args)
+{
+    int* sum = data;
+    *sum += args->a * args->b;
+}
+EVENT_CHANNEL_OBSERVER_DEF(ChannelTest, _channel_test_callback);
+
+static void _test_event_send_channel(void* userstate)
+{
+    struct QueuedEventTestState* state = userstate;
+
+    // Replace the int sized queue from setup with one sized for the channel's args
+    event_uninit(&state->event);
+    EVENT_CHANNEL_INIT_QUEUED(ChannelTest)(&state->event, 2);
+
+    int sum = 0;
+    ObserverHandle obs = observer_create(&sum, EVENT_CHANNEL_OBSERVER(_channel_test_callback));
+    event_register_observer(&state->event, obs);
+
+    for(int i = 1; i <= 3; ++i)
+    {
+        struct ChannelTestArgs args = { i, 10 };
+        EVENT_CHANNEL_SEND(ChannelTest)(&state->event, &args);
+    }
+
+    test_assert_equal_int("not sent before flush", 0, sum);
+    event_flush(&state->event);
+    test_assert_equal_int("sum after flush", 60, sum);
+
+    event_deregister_observer(&state->event, obs);
+    observer_destroy(obs);
+}
+
+void test_event_send_channel(void)
+{
+    struct QueuedEventTestState state;
+    testing_add_group("send channel");
+    testing_add_test("event send typed channel", &_setup_queued, &_teardown_queued, &_test_event_send_channel, &state, sizeof(state));
+}
+
 void test_event_run_all(void)
 {
     test_event_register_deregister();
     test_event_send();
+    test_event_send_queued();
+    test_event_send_channel();
+    test_event_send_concurrent();
 }
@@ -0,0 +1,51 @@
+#include "scieppend/test/core/hash.h"
+
+#include "scieppend/core/hash.h"
+#include "scieppend/test/test.h"
+#include <string.h>
+
+static void _test_hash_stable([[maybe_unused]] void* userstate)
+{
+    // These values are stored in the tree as prehashed constants, so they must never change
+    test_assert_equal_int("null component type", 288057177, hash("__NullComponentType", strlen("__NullComponentType")));
+    test_assert_equal_int("null system type", -1361462198, hash("__NullSystemType", strlen("__NullSystemType")));
+
+    test_assert_equal_int("empty", 671197736, hash("", 0));
+    test_assert_equal_int("tail only", -785630587, hash("a", 1));
+    test_assert_equal_int("words and tail", 1370332759, hash("system_name", strlen("system_name")));
+
+    const char* long_key = "a string that is longer than one 32 byte stripe, for the lane path";
+    test_assert_equal_int("stripes, words and tail", 1466182102, hash(long_key, strlen(long_key)));
+}
+
+void test_hash_stable(void)
+{
+    testing_add_group("hash stable");
+    testing_add_test("stable", NULL, NULL, &_test_hash_stable, NULL, 0);
+}
+
+static void _test_hash_unaligned([[maybe_unused]] void* userstate)
+{
+    const char* key = "a string that is longer than one 32 byte stripe, for the lane path";
+    int key_bytes = strlen(key);
+    char buffer[128];
+
+    unsigned long long expect = hash64(key, key_bytes);
+    for(int offset = 1; offset < 8; ++offset)
+    {
+        memcpy(buffer + offset, key, key_bytes);
+        test_assert_equal_bool("same hash at offset", true, hash64(buffer + offset, key_bytes) == expect);
+    }
+}
+
+void test_hash_unaligned(void)
+{
+    testing_add_group("hash unaligned");
+    testing_add_test("unaligned", NULL, NULL, &_test_hash_unaligned, NULL, 0);
+}
+
+void test_hash_run_all(void)
+{
+    test_hash_stable();
+    test_hash_unaligned();
+}
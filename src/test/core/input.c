@@ -0,0 +1,181 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "scieppend/test/core/input.h"
+
+#include "scieppend/core/input.h"
+#include "scieppend/test/test.h"
+
+#include <string.h>
+#include <threads.h>
+#include <unistd.h>
+
+#define C_INPUT_TEST_POLL_ATTEMPTS 100
+
+static void _setup(void* userstate)
+{
+    struct InputParser* parser = userstate;
+    input_parser_init(parser);
+}
+
+static void _feed(struct InputParser* parser, const char* bytes)
+{
+    input_parser_feed(parser, bytes, strlen(bytes));
+}
+
+// PARSER
+
+static void _test_input__parser__keys_in_one_read(void* userstate)
+{
+    struct InputParser* parser = userstate;
+
+    _feed(parser, "ab\033[Ac");
+    test_assert_equal_int("key count", 4, parser->key_count);
+    test_assert_equal_int("first char", 'a', parser->keys[0]);
+    test_assert_equal_int("second char", 'b', parser->keys[1]);
+    test_assert_equal_int("arrow", KEYCODE_ARROW_UP, parser->keys[2]);
+    test_assert_equal_int("char after arrow", 'c', parser->keys[3]);
+    test_assert_equal_bool("nothing pending", false, input_parser_has_pending(parser));
+}
+
+static void _test_input__parser__split_sequence(void* userstate)
+{
+    struct InputParser* parser = userstate;
+
+    _feed(parser, "\033");
+    test_assert_equal_int("escape alone", 0, parser->key_count);
+    test_assert_equal_bool("escape pending", true, input_parser_has_pending(parser));
+
+    _feed(parser, "[");
+    test_assert_equal_int("csi alone", 0, parser->key_count);
+
+    _feed(parser, "B");
+    test_assert_equal_int("completed key count", 1, parser->key_count);
+    test_assert_equal_int("completed key", KEYCODE_ARROW_DOWN, parser->keys[0]);
+    test_assert_equal_bool("nothing pending", false, input_parser_has_pending(parser));
+}
+
+static void _test_input__parser__ss3_and_csi(void* userstate)
+{
+    struct InputParser* parser = userstate;
+
+    _feed(parser, "\033OC\033[D");
+    test_assert_equal_int("key count", 2, parser->key_count);
+    test_assert_equal_int("ss3", KEYCODE_ARROW_RIGHT, parser->keys[0]);
+    test_assert_equal_int("csi", KEYCODE_ARROW_LEFT, parser->keys[1]);
+}
+
+static void _test_input__parser__unknown_sequence(void* userstate)
+{
+    struct InputParser* parser = userstate;
+
+    // The parameters and final byte are not taken as key presses
+    _feed(parser, "\033[1;5Zx");
+    test_assert_equal_int("key count", 1, parser->key_count);
+    test_assert_equal_int("char after sequence", 'x', parser->keys[0]);
+}
+
+static void _test_input__parser__escape_key(void* userstate)
+{
+    struct InputParser* parser = userstate;
+
+    _feed(parser, "\033");
+    input_parser_flush(parser);
+    test_assert_equal_int("flushed key count", 1, parser->key_count);
+    test_assert_equal_int("flushed escape", KEYCODE_ESC, parser->keys[0]);
+    test_assert_equal_bool("nothing pending", false, input_parser_has_pending(parser));
+
+    // Escape followed by a normal key, e.g. alt + key
+    _feed(parser, "\033a");
+    test_assert_equal_int("alt key count", 2, parser->key_count);
+    test_assert_equal_int("alt escape", KEYCODE_ESC, parser->keys[0]);
+    test_assert_equal_int("alt char", 'a', parser->keys[1]);
+}
+
+static void _test_input__parser__endless_sequence(void* userstate)
+{
+    struct InputParser* parser = userstate;
+    char bytes[INPUT_PARSER_BUFFER_SIZE + 16];
+
+    memset(bytes, '1', sizeof(bytes));
+    bytes[0] = '\033';
+    bytes[1] = '[';
+
+    input_parser_feed(parser, bytes, sizeof(bytes));
+    test_assert_equal_int("given up escape", KEYCODE_ESC, parser->keys[0]);
+    test_assert_equal_bool("nothing pending", false, input_parser_has_pending(parser));
+}
+
+void test_input_parser(void)
+{
+    struct InputParser parser;
+
+    testing_add_group("input parser");
+    testing_add_test("keys in one read", &_setup, NULL, &_test_input__parser__keys_in_one_read, &parser, sizeof(parser));
+    testing_add_test("split sequence", &_setup, NULL, &_test_input__parser__split_sequence, &parser, sizeof(parser));
+    testing_add_test("ss3 and csi", &_setup, NULL, &_test_input__parser__ss3_and_csi, &parser, sizeof(parser));
+    testing_add_test("unknown sequence", &_setup, NULL, &_test_input__parser__unknown_sequence, &parser, sizeof(parser));
+    testing_add_test("escape key", &_setup, NULL, &_test_input__parser__escape_key, &parser, sizeof(parser));
+    testing_add_test("endless sequence", &_setup, NULL, &_test_input__parser__endless_sequence, &parser, sizeof(parser));
+}
+
+// THREAD
+
+// Polls until the input thread has queued something, or gives up
+static const enum KeyCode* _poll_keys(int* count)
+{
+    const enum KeyCode* keys = NULL;
+    *count = 0;
+
+    for(int i = 0; i < C_INPUT_TEST_POLL_ATTEMPTS && *count == 0; ++i)
+    {
+        thrd_sleep(&(struct timespec){ .tv_nsec = 10 * 1000 * 1000 }, NULL);
+        input_poll();
+        keys = input_get_keys(count);
+    }
+
+    return keys;
+}
+
+static void _test_input__thread__escape_timeout([[maybe_unused]] void* userstate)
+{
+    int fds[2];
+    test_assert_equal_int("pipe", 0, pipe(fds));
+
+    // Read from the pipe in place of stdin
+    int saved_stdin = dup(STDIN_FILENO);
+    dup2(fds[0], STDIN_FILENO);
+    input_init();
+
+    int count = 0;
+    const enum KeyCode* keys = NULL;
+
+    // Nothing follows, so it is only taken as a key press once the timeout passes
+    write(fds[1], "\033", 1);
+    keys = _poll_keys(&count);
+    test_assert_equal_int("escape count", 1, count);
+    test_assert_equal_int("escape", KEYCODE_ESC, count > 0 ? keys[0] : KEYCODE_UNKNOWN);
+
+    write(fds[1], "\033[", 2);
+    write(fds[1], "A", 1);
+    keys = _poll_keys(&count);
+    test_assert_equal_int("arrow count", 1, count);
+    test_assert_equal_int("arrow", KEYCODE_ARROW_UP, count > 0 ? keys[0] : KEYCODE_UNKNOWN);
+
+    input_uninit();
+    dup2(saved_stdin, STDIN_FILENO);
+    close(saved_stdin);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+void test_input_thread(void)
+{
+    testing_add_group("input thread");
+    testing_add_test("escape timeout", NULL, NULL, &_test_input__thread__escape_timeout, NULL, 0);
+}
+
+void test_input_run_all(void)
+{
+    test_input_parser();
+    test_input_thread();
+}
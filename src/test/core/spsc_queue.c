@@ -0,0 +1,144 @@
+#include "scieppend/test/core/spsc_queue.h"
+
+#include "scieppend/core/concurrent/spsc_queue.h"
+#include "scieppend/test/test.h"
+
+#include <threads.h>
+
+#define C_SPSC_TEST_CAPACITY 8
+#define C_SPSC_TEST_THREADED_COUNT 100000
+
+static void _setup(void* userstate)
+{
+    struct SPSCQueue* queue = userstate;
+    spsc_queue_init(queue, sizeof(int), C_SPSC_TEST_CAPACITY);
+}
+
+static void _teardown(void* userstate)
+{
+    struct SPSCQueue* queue = userstate;
+    spsc_queue_uninit(queue);
+}
+
+// PUSH POP
+
+static void _test_spsc_queue__push_pop__order(void* userstate)
+{
+    struct SPSCQueue* queue = userstate;
+    int item = 0;
+
+    test_assert_equal_bool("pop empty", false, spsc_queue_pop(queue, &item));
+
+    for(int i = 0; i < 5; ++i)
+    {
+        spsc_queue_push(queue, &i);
+    }
+    test_assert_equal_int("count", 5, spsc_queue_count(queue));
+
+    for(int i = 0; i < 5; ++i)
+    {
+        spsc_queue_pop(queue, &item);
+        test_assert_equal_int("fifo order", i, item);
+    }
+    test_assert_equal_int("count after pop", 0, spsc_queue_count(queue));
+}
+
+static void _test_spsc_queue__push_pop__full(void* userstate)
+{
+    struct SPSCQueue* queue = userstate;
+    int item = 0;
+
+    // Fill and drain a few times so the indices wrap around the buffer
+    for(int round = 0; round < 3; ++round)
+    {
+        for(int i = 0; i < C_SPSC_TEST_CAPACITY; ++i)
+        {
+            item = round * C_SPSC_TEST_CAPACITY + i;
+            test_assert_equal_bool("push", true, spsc_queue_push(queue, &item));
+        }
+
+        test_assert_equal_bool("push full", false, spsc_queue_push(queue, &item));
+
+        for(int i = 0; i < C_SPSC_TEST_CAPACITY; ++i)
+        {
+            spsc_queue_pop(queue, &item);
+            test_assert_equal_int("wrapped order", round * C_SPSC_TEST_CAPACITY + i, item);
+        }
+    }
+}
+
+static void _test_spsc_queue__push_pop__capacity([[maybe_unused]] void* userstate)
+{
+    struct SPSCQueue queue;
+    spsc_queue_init(&queue, sizeof(int), 5);
+    test_assert_equal_int("rounded to power of two", 8, spsc_queue_capacity(&queue));
+    spsc_queue_uninit(&queue);
+}
+
+void test_spsc_queue_push_pop(void)
+{
+    struct SPSCQueue queue;
+
+    testing_add_group("spsc queue push pop");
+    testing_add_test("order", &_setup, &_teardown, &_test_spsc_queue__push_pop__order, &queue, sizeof(queue));
+    testing_add_test("full", &_setup, &_teardown, &_test_spsc_queue__push_pop__full, &queue, sizeof(queue));
+    testing_add_test("capacity", NULL, NULL, &_test_spsc_queue__push_pop__capacity, NULL, 0);
+}
+
+// THREADED
+
+static int _producer(void* userstate)
+{
+    struct SPSCQueue* queue = userstate;
+    for(int i = 0; i < C_SPSC_TEST_THREADED_COUNT; ++i)
+    {
+        while(!spsc_queue_push(queue, &i))
+        {
+            thrd_yield();
+        }
+    }
+
+    return 0;
+}
+
+static void _test_spsc_queue__threaded__in_order(void* userstate)
+{
+    struct SPSCQueue* queue = userstate;
+
+    thrd_t producer;
+    thrd_create(&producer, &_producer, queue);
+
+    int expect = 0;
+    int item = 0;
+    bool in_order = true;
+    while(expect < C_SPSC_TEST_THREADED_COUNT)
+    {
+        if(!spsc_queue_pop(queue, &item))
+        {
+            thrd_yield();
+            continue;
+        }
+
+        in_order = in_order && item == expect;
+        ++expect;
+    }
+
+    thrd_join(producer, NULL);
+
+    test_assert_equal_bool("all items in order", true, in_order);
+    test_assert_equal_int("empty", 0, spsc_queue_count(queue));
+}
+
+void test_spsc_queue_threaded(void)
+{
+    struct SPSCQueue queue;
+
+    testing_add_group("spsc queue threaded");
+    testing_add_test("in order", &_setup, &_teardown, &_test_spsc_queue__threaded__in_order, &queue, sizeof(queue));
+}
+
+void test_spsc_queue_run_all(void)
+{
+    test_spsc_queue_push_pop();
+    test_spsc_queue_threaded();
+}
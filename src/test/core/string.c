@@ -0,0 +1,98 @@
+#include "scieppend/test/core/string.h"
+
+#include "scieppend/core/hash.h"
+#include "scieppend/core/string.h"
+#include "scieppend/test/test.h"
+
+#include <string.h>
+
+// STORAGE
+
+static void _test_string__storage__inline_and_heap(void* userstate)
+{
+    struct string* str = userstate;
+
+    string_init(str, "123456789012345");
+    test_assert_equal_int("inline size", 15, str->size);
+    test_assert_equal_bool("inline", true, string_cstr(str) == str->inline_buffer);
+    test_assert_equal_char_buffer("inline chars", "123456789012345", string_cstr(str));
+
+    string_set(str, "1234567890123456");
+    test_assert_equal_int("heap size", 16, str->size);
+    test_assert_equal_bool("heap", false, string_cstr(str) == str->inline_buffer);
+    test_assert_equal_char_buffer("heap chars", "1234567890123456", string_cstr(str));
+
+    string_set(str, "short");
+    test_assert_equal_int("shrunk size", 5, str->size);
+    test_assert_equal_char_buffer("shrunk chars", "short", string_cstr(str));
+
+    string_format(str, "%s_%d", "formatted_string", 42);
+    test_assert_equal_int("formatted size", 19, str->size);
+    test_assert_equal_char_buffer("formatted chars", "formatted_string_42", string_cstr(str));
+
+    string_uninit(str);
+}
+
+static void _test_string__storage__cached_hash(void* userstate)
+{
+    struct string* str = userstate;
+
+    string_init(str, "TestSystemName");
+    test_assert_equal_int("hash", hash("TestSystemName", 14), string_hash(str));
+
+    string_format(str, "dummy_component_%d", 7);
+    test_assert_equal_int("hash after format", hash("dummy_component_7", 17), string_hash(str));
+
+    string_set(str, "a");
+    test_assert_equal_int("hash after set", hash("a", 1), string_hash(str));
+
+    string_uninit(str);
+}
+
+void test_string_storage(void)
+{
+    struct string str;
+    testing_add_group("string storage");
+    testing_add_test("inline and heap", NULL, NULL, &_test_string__storage__inline_and_heap, &str, sizeof(str));
+    testing_add_test("cached hash", NULL, NULL, &_test_string__storage__cached_hash, &str, sizeof(str));
+}
+
+// INTERN
+
+static void _test_string__intern__ids(void* userstate)
+{
+    struct string* str = userstate;
+
+    string_init(str, "a long interned string name");
+
+    int id = string_intern(str);
+    test_assert_nequal_int("id not null", C_NULL_STRING_ID, id);
+    test_assert_equal_int("same chars same id", id, string_intern_chars("a long interned string name"));
+    test_assert_equal_char_buffer("chars for id", "a long interned string name", string_intern_get(id));
+    test_assert_equal_int("found id", id, string_intern_find(str));
+
+    int other_id = string_intern_chars("other");
+    test_assert_nequal_int("different chars different id", id, other_id);
+    test_assert_equal_char_buffer("chars for other id", "other", string_intern_get(other_id));
+
+    test_assert_null("unknown id", string_intern_get(other_id + 1));
+    test_assert_null("null id", string_intern_get(C_NULL_STRING_ID));
+
+    string_set(str, "never interned");
+    test_assert_equal_int("not found", C_NULL_STRING_ID, string_intern_find(str));
+
+    string_uninit(str);
+}
+
+void test_string_intern(void)
+{
+    struct string str;
+    testing_add_group("string intern");
+    testing_add_test("ids", NULL, NULL, &_test_string__intern__ids, &str, sizeof(str));
+}
+
+void test_string_run_all(void)
+{
+    test_string_storage();
+    test_string_intern();
+}
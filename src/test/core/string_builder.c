@@ -0,0 +1,154 @@
+#include "scieppend/test/core/string_builder.h"
+
+#include "scieppend/core/hash.h"
+#include "scieppend/core/string.h"
+#include "scieppend/core/string_builder.h"
+#include "scieppend/test/test.h"
+
+#include <limits.h>
+
+static void _setup(void* userstate)
+{
+    struct StringBuilder* builder = userstate;
+    string_builder_init(builder, 0);
+}
+
+static void _teardown(void* userstate)
+{
+    struct StringBuilder* builder = userstate;
+    string_builder_uninit(builder);
+}
+
+// APPEND
+
+static void _test_string_builder__append__mixed(void* userstate)
+{
+    struct StringBuilder* builder = userstate;
+
+    test_assert_equal_char_buffer("empty", "", string_builder_cstr(builder));
+
+    string_builder_append(builder, "entity ");
+    string_builder_append_int(builder, 42);
+    string_builder_append_char(builder, ' ');
+    string_builder_append_int(builder, -7);
+    string_builder_append_char(builder, ' ');
+    string_builder_append_int(builder, INT_MIN);
+    string_builder_append_char(builder, ' ');
+    string_builder_append_uint(builder, UINT_MAX);
+    string_builder_append_repeat(builder, '.', 3);
+    string_builder_append_format(builder, "%s=%d", "x", 0);
+
+    test_assert_equal_char_buffer("chars", "entity 42 -7 -2147483648 4294967295...x=0", string_builder_cstr(builder));
+    test_assert_equal_int("size", 41, string_builder_size(builder));
+
+    string_builder_clear(builder);
+    test_assert_equal_char_buffer("cleared", "", string_builder_cstr(builder));
+}
+
+static void _test_string_builder__append__growth(void* userstate)
+{
+    struct StringBuilder* builder = userstate;
+
+    for(int i = 0; i < 1000; ++i)
+    {
+        string_builder_append_char(builder, (char)('a' + (i % 26)));
+    }
+
+    test_assert_equal_int("size", 1000, string_builder_size(builder));
+    test_assert_equal_bool("capacity", true, builder->capacity >= 1001);
+    test_assert_equal_int("first char", 'a', string_builder_cstr(builder)[0]);
+    test_assert_equal_int("last char", 'a' + (999 % 26), string_builder_cstr(builder)[999]);
+    test_assert_equal_int("terminator", '\0', string_builder_cstr(builder)[1000]);
+}
+
+static void _test_string_builder__append__caller_buffer(void* userstate)
+{
+    struct StringBuilder* builder = userstate;
+    char buffer[8];
+
+    string_builder_uninit(builder);
+    string_builder_init_buffer(builder, buffer, sizeof(buffer));
+
+    string_builder_append(builder, "1234567");
+    test_assert_equal_bool("in caller buffer", true, string_builder_cstr(builder) == buffer);
+    test_assert_equal_char_buffer("chars", "1234567", string_builder_cstr(builder));
+
+    string_builder_append_char(builder, '8');
+    test_assert_equal_bool("moved to heap", false, string_builder_cstr(builder) == buffer);
+    test_assert_equal_char_buffer("moved chars", "12345678", string_builder_cstr(builder));
+}
+
+void test_string_builder_append(void)
+{
+    struct StringBuilder builder;
+    testing_add_group("string builder append");
+    testing_add_test("mixed", &_setup, &_teardown, &_test_string_builder__append__mixed, &builder, sizeof(builder));
+    testing_add_test("growth", &_setup, &_teardown, &_test_string_builder__append__growth, &builder, sizeof(builder));
+    testing_add_test("caller buffer", &_setup, &_teardown, &_test_string_builder__append__caller_buffer, &builder, sizeof(builder));
+}
+
+// TO STRING
+
+static void _test_string_builder__to_string__inline(void* userstate)
+{
+    struct StringBuilder* builder = userstate;
+    struct string str;
+
+    string_builder_append(builder, "short");
+    string_builder_to_string(builder, &str);
+
+    test_assert_equal_char_buffer("string chars", "short", string_cstr(&str));
+    test_assert_equal_int("builder emptied", 0, string_builder_size(builder));
+
+    string_uninit(&str);
+}
+
+static void _test_string_builder__to_string__take_buffer(void* userstate)
+{
+    struct StringBuilder* builder = userstate;
+    struct string str;
+
+    string_builder_append(builder, "a string too long to be inline");
+    const char* built = string_builder_cstr(builder);
+    string_builder_to_string(builder, &str);
+
+    test_assert_equal_bool("buffer taken", true, string_cstr(&str) == built);
+    test_assert_equal_char_buffer("string chars", "a string too long to be inline", string_cstr(&str));
+    test_assert_equal_int("string hash", hash("a string too long to be inline", 30), string_hash(&str));
+    test_assert_equal_int("builder emptied", 0, string_builder_size(builder));
+
+    string_uninit(&str);
+}
+
+static void _test_string_builder__to_string__caller_buffer(void* userstate)
+{
+    struct StringBuilder* builder = userstate;
+    struct string str;
+    char buffer[64];
+
+    string_builder_uninit(builder);
+    string_builder_init_buffer(builder, buffer, sizeof(buffer));
+
+    string_builder_append(builder, "a string too long to be inline");
+    string_builder_to_string(builder, &str);
+
+    test_assert_equal_bool("buffer copied", false, string_cstr(&str) == buffer);
+    test_assert_equal_char_buffer("string chars", "a string too long to be inline", string_cstr(&str));
+
+    string_uninit(&str);
+}
+
+void test_string_builder_to_string(void)
+{
+    struct StringBuilder builder;
+    testing_add_group("string builder to string");
+    testing_add_test("inline", &_setup, &_teardown, &_test_string_builder__to_string__inline, &builder, sizeof(builder));
+    testing_add_test("take buffer", &_setup, &_teardown, &_test_string_builder__to_string__take_buffer, &builder, sizeof(builder));
+    testing_add_test("caller buffer", &_setup, &_teardown, &_test_string_builder__to_string__caller_buffer, &builder, sizeof(builder));
+}
+
+void test_string_builder_run_all(void)
+{
+    test_string_builder_append();
+    test_string_builder_to_string();
+}
@@ -0,0 +1,265 @@
+#include "scieppend/test/core/term.h"
+
+#include "scieppend/core/colour.h"
+#include "scieppend/core/term.h"
+#include "scieppend/test/test.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define C_TERM_TEST_WIDTH 20
+#define C_TERM_TEST_HEIGHT 4
+#define C_TERM_TEST_SINK_PATH "term_sink_test.out"
+
+// Clear from the initial resize, then one red run of text with a single reset inside a synchronized update
+#define C_TERM_TEST_HELLO_FRAME "\033[2J\033[?2026h\033[1;1f\033[38;2;255;0;0mhello\033[0m\033[?2026l"
+
+static void _setup([[maybe_unused]] void* userstate)
+{
+    term_init_headless(C_TERM_TEST_WIDTH, C_TERM_TEST_HEIGHT, NULL);
+}
+
+static void _teardown([[maybe_unused]] void* userstate)
+{
+    term_uninit();
+}
+
+static void _draw_hello(void)
+{
+    struct Colour red = { 255, 0, 0 };
+    term_draw_text(0, 0, &red, NULL, A_NONE_BIT, "hello");
+}
+
+static void _test_term_headless__refresh([[maybe_unused]] void* userstate)
+{
+    struct TermSinkStats stats;
+
+    _draw_hello();
+    term_refresh();
+    term_get_sink_stats(&stats);
+
+    test_assert_equal_int("frames", 1, stats.frames);
+    test_assert_equal_int("frame bytes", strlen(C_TERM_TEST_HELLO_FRAME), stats.frame_bytes);
+    test_assert_equal_int("frame escape sequences", 6, stats.frame_escape_sequences);
+
+    term_refresh();
+    term_get_sink_stats(&stats);
+
+    test_assert_equal_int("unchanged frames", 2, stats.frames);
+    test_assert_equal_int("unchanged frame bytes", 0, stats.frame_bytes);
+
+    term_clear();
+    _draw_hello();
+    term_refresh();
+    term_get_sink_stats(&stats);
+
+    test_assert_equal_int("redrawn frame bytes", 0, stats.frame_bytes);
+}
+
+static void _test_term_headless__render_thread([[maybe_unused]] void* userstate)
+{
+    struct TermSinkStats stats;
+
+    term_start_render_thread();
+    _draw_hello();
+    term_refresh();
+    term_stop_render_thread();
+    term_get_sink_stats(&stats);
+
+    test_assert_equal_int("frames", 1, stats.frames);
+    test_assert_equal_int("frame bytes", strlen(C_TERM_TEST_HELLO_FRAME), stats.frame_bytes);
+}
+
+static void _test_term_headless__render_thread_cursor([[maybe_unused]] void* userstate)
+{
+    struct TermSinkStats stats;
+
+    // The move is written by the render thread, after the cells that moved the cursor
+    term_start_render_thread();
+    _draw_hello();
+    term_move_cursor(3, 2);
+    term_refresh();
+    term_stop_render_thread();
+    term_get_sink_stats(&stats);
+
+    test_assert_equal_int("frame bytes", strlen("\033[2J\033[?2026h\033[1;1f\033[38;2;255;0;0mhello\033[0m\033[3;4f\033[?2026l"), stats.frame_bytes);
+
+    // Nothing moved it since, so it is left alone
+    term_refresh();
+    term_get_sink_stats(&stats);
+
+    test_assert_equal_int("unchanged frame bytes", 0, stats.frame_bytes);
+}
+
+static void _test_term_headless__render_thread_cursor_visibility([[maybe_unused]] void* userstate)
+{
+    struct TermSinkStats stats;
+    term_get_sink_stats(&stats);
+    unsigned long long bytes = stats.bytes;
+
+    // Nothing is written from this thread, the render thread shows it with the next frame
+    term_start_render_thread();
+    term_set_cursor(true);
+    term_refresh();
+    term_stop_render_thread();
+    term_get_sink_stats(&stats);
+
+    const char* expect = "\033[2J\033[?2026h\033[?25h\033[?2026l";
+    test_assert_equal_int("frame bytes", strlen(expect), stats.frame_bytes);
+    test_assert_equal_int("bytes", bytes + strlen(expect), stats.bytes);
+}
+
+static void _test_term_headless__sink_file([[maybe_unused]] void* userstate)
+{
+    const char* expect = "\033[?1049h\033[?25l" C_TERM_TEST_HELLO_FRAME "\033[?25h\033[?1049l";
+
+    term_init_headless(C_TERM_TEST_WIDTH, C_TERM_TEST_HEIGHT, C_TERM_TEST_SINK_PATH);
+    _draw_hello();
+    term_refresh();
+    term_uninit();
+
+    char actual[256] = { 0 };
+    FILE* file = fopen(C_TERM_TEST_SINK_PATH, "rb");
+    test_assert_not_null("file", file);
+    if(file)
+    {
+        fread(actual, 1, sizeof(actual) - 1, file);
+        fclose(file);
+    }
+
+    test_assert_equal_char_buffer("output", expect, actual);
+
+    remove(C_TERM_TEST_SINK_PATH);
+}
+
+static void _draw_lines(int first_line, int count)
+{
+    char line[C_TERM_TEST_WIDTH + 1];
+    for(int y = 0; y < count; ++y)
+    {
+        snprintf(line, sizeof(line), "line %d", first_line + y);
+        term_draw_text(0, y, NULL, NULL, A_NONE_BIT, line);
+    }
+}
+
+static void _test_term_headless__scroll([[maybe_unused]] void* userstate)
+{
+    struct TermSinkStats stats;
+    const int height = 8;
+
+    term_init_headless(C_TERM_TEST_WIDTH, height, C_TERM_TEST_SINK_PATH);
+
+    _draw_lines(0, height);
+    term_refresh();
+    term_get_sink_stats(&stats);
+    unsigned long long full_bytes = stats.frame_bytes;
+
+    // Content moves up a row, so only the new bottom row should be drawn
+    term_clear();
+    _draw_lines(1, height);
+    term_refresh();
+    term_get_sink_stats(&stats);
+    test_assert_equal_bool("fewer bytes than a repaint", true, stats.frame_bytes < full_bytes / 2);
+    unsigned long long scroll_bytes = stats.frame_bytes;
+
+    // And back down again
+    term_clear();
+    _draw_lines(0, height);
+    term_refresh();
+
+    // A change to one row is rendered without hashing the frame, the same scroll after it must still be found
+    term_draw_text(0, 4, NULL, NULL, A_NONE_BIT, "first");
+    term_refresh();
+    term_clear();
+    _draw_lines(1, height);
+    term_draw_text(0, 3, NULL, NULL, A_NONE_BIT, "first");
+    term_refresh();
+    term_get_sink_stats(&stats);
+    test_assert_equal_int("scroll after an unhashed frame", scroll_bytes, stats.frame_bytes);
+
+    term_uninit();
+
+    char actual[1024] = { 0 };
+    FILE* file = fopen(C_TERM_TEST_SINK_PATH, "rb");
+    test_assert_not_null("file", file);
+    if(file)
+    {
+        fread(actual, 1, sizeof(actual) - 1, file);
+        fclose(file);
+    }
+
+    test_assert_not_null("scrolled up", strstr(actual, "\033[1;8r\033[1S\033[r\033[8;1fline\033[8;6f8"));
+    test_assert_not_null("scrolled down", strstr(actual, "\033[1;8r\033[1T\033[r\033[1;1fline\033[1;6f0"));
+
+    remove(C_TERM_TEST_SINK_PATH);
+}
+
+static void _test_term_headless__colour_modes([[maybe_unused]] void* userstate)
+{
+    term_init_headless(C_TERM_TEST_WIDTH, C_TERM_TEST_HEIGHT, C_TERM_TEST_SINK_PATH);
+
+    _draw_hello();
+    term_set_colour_mode(COLOUR_MODE_256);
+    term_refresh();
+    term_set_colour_mode(COLOUR_MODE_16);
+    term_refresh();
+
+    term_uninit();
+
+    char actual[4096] = { 0 };
+    FILE* file = fopen(C_TERM_TEST_SINK_PATH, "rb");
+    test_assert_not_null("file", file);
+    if(file)
+    {
+        fread(actual, 1, sizeof(actual) - 1, file);
+        fclose(file);
+    }
+
+    test_assert_not_null("256 colour", strstr(actual, "\033[38;5;196mhello"));
+    test_assert_not_null("16 colour", strstr(actual, "\033[91mhello"));
+
+    remove(C_TERM_TEST_SINK_PATH);
+}
+
+static void _test_term_headless__glyphs([[maybe_unused]] void* userstate)
+{
+    struct TermSinkStats stats;
+
+    int line = term_register_glyph("\u2500", 1);
+    int wide = term_register_glyph("\u4f60", 2);
+    test_assert_equal_int("first registered id", 128, line);
+    test_assert_equal_int("same glyph same id", line, term_register_glyph("\u2500", 1));
+    test_assert_equal_int("too wide", -1, term_register_glyph("\u4f60", 3));
+
+    // The wide glyph covers two columns, so the text after it needs no cursor move
+    term_draw_glyph(0, 0, NULL, NULL, A_NONE_BIT, wide);
+    term_draw_glyph(2, 0, NULL, NULL, A_NONE_BIT, line);
+    term_draw_symbol(3, 0, NULL, NULL, A_NONE_BIT, 'a');
+    term_refresh();
+    term_get_sink_stats(&stats);
+    test_assert_equal_int("frame bytes", strlen("\033[2J\033[?2026h\033[1;1f\u4f60\u2500a\033[?2026l"), stats.frame_bytes);
+
+    // Overwriting the right half also blanks the left
+    term_draw_symbol(1, 0, NULL, NULL, A_NONE_BIT, 'b');
+    term_refresh();
+    term_get_sink_stats(&stats);
+    test_assert_equal_int("overwritten frame bytes", strlen("\033[?2026h\033[1;1f b\033[?2026l"), stats.frame_bytes);
+}
+
+void test_term_headless(void)
+{
+    testing_add_group("term headless");
+    testing_add_test("refresh", &_setup, &_teardown, &_test_term_headless__refresh, NULL, 0);
+    testing_add_test("render thread", &_setup, &_teardown, &_test_term_headless__render_thread, NULL, 0);
+    testing_add_test("render thread cursor", &_setup, &_teardown, &_test_term_headless__render_thread_cursor, NULL, 0);
+    testing_add_test("render thread cursor visibility", &_setup, &_teardown, &_test_term_headless__render_thread_cursor_visibility, NULL, 0);
+    testing_add_test("sink file", NULL, NULL, &_test_term_headless__sink_file, NULL, 0);
+    testing_add_test("scroll", NULL, NULL, &_test_term_headless__scroll, NULL, 0);
+    testing_add_test("colour modes", NULL, NULL, &_test_term_headless__colour_modes, NULL, 0);
+    testing_add_test("glyphs", &_setup, &_teardown, &_test_term_headless__glyphs, NULL, 0);
+}
+
+void test_term_run_all(void)
+{
+    test_term_headless();
+}
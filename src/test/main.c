@@ -4,13 +4,22 @@
 #include "scieppend/test/core/cache_map.h"
 #include "scieppend/test/core/ecs.h"
 #include "scieppend/test/core/event.h"
+#include "scieppend/test/core/hash.h"
+#include "scieppend/test/core/input.h"
+#include "scieppend/test/core/spsc_queue.h"
 #include "scieppend/test/core/stack_array.h"
+#include "scieppend/test/core/string.h"
+#include "scieppend/test/core/string_builder.h"
+#include "scieppend/test/core/term.h"
 #include "scieppend/test/core/link_array.h"
 
 int main(int argc, char** argv)
 {
     test_init(true);
 
+    test_hash_run_all();
+    test_string_run_all();
+    test_string_builder_run_all();
     test_array_run_all();
     test_stackarray_run_all();
     test_cache_run_all();
@@ -18,6 +27,9 @@ int main(int argc, char** argv)
     test_cache_map_run_all();
     test_ecs_run_all();
     test_event_run_all();
+    test_spsc_queue_run_all();
+    test_input_run_all();
+    test_term_run_all();
 
     testing_run_tests();
     testing_report();